@@ -0,0 +1,670 @@
+//
+//##################################################################
+//                     SCC_CompactSymFun.h
+//##################################################################
+//
+// A compact representation of an SCC::SymFun for applications that
+// create very large numbers of instances of small expressions.
+//
+// Chris Anderson (C) UCLA 2022
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <sstream>
+
+#include "SCC_SymFun.h"
+#include "SCC_RealOperatorLib.h"
+#include "SCC_SymFunSymbolTable.h"
+
+#ifndef COMPACT_SYMFUN_
+#define COMPACT_SYMFUN_
+
+namespace SCC
+{
+
+/*!
+ \class SCC::CompactSymFun
+ \brief A compact representation of an SCC::SymFun for use when very large numbers of instances are required
+
+ An SCC::CompactSymFun evaluates the same functions as an SCC::SymFun, but stores
+ the compiled program in a form that minimizes the memory used by each instance:
+
+ (*) the operator and operand indices of the program are 16 bit values (32 bit values for programs
+ whose evaluation data has more than 65535 entries).
+
+ (*) the names of the variables and symbolic constants are interned in the process wide
+ SCC::SymFunSymbolTable and each instance stores only their ids.
+
+ (*) the program, the values of the constants and numeric literals, the name ids and the expression
+ string are stored in a buffer within the instance when they fit (typically short expressions with up to
+ two or three operations), and otherwise in a single heap allocation.
+
+ (*) the operator functions are obtained from the static tables of SCC::RealOperatorLib.
+
+ The evaluation data is assembled on the stack for each evaluation (in a buffer of the evaluating
+ thread for large programs), so evaluation does not modify the instance and an instance may be
+ evaluated concurrently.
+
+ Instances are created from an SCC::SymFun or with the same arguments as the SCC::SymFun constructors.
+ An SCC::SymFunException is generated if the function has more than 65535 variables or symbolic constants.
+ Operations not provided by this class (batch evaluation, differentiation) are available
+ through the SCC::SymFun returned by getSymFun().
+
+\headerfile SCC_CompactSymFun.h "SCC_CompactSymFun.h"
+*/
+
+class CompactSymFun
+{
+public:
+
+    /**
+      Null constructor. The instance created must be initialized with
+      one of the initialize(...) member functions.
+    */
+
+    CompactSymFun()
+    {
+        initialize();
+    }
+
+    /**
+      Creates a compact representation of F.
+    */
+
+    CompactSymFun(const SymFun& F)
+    {
+        initialize();
+        initialize(F);
+    }
+
+    /**
+      Creates an instance that is a function in one variable, x, specified by
+      the std::string S.
+    */
+
+    CompactSymFun(const std::string& S)
+    {
+        initialize();
+        initialize(SymFun(S));
+    }
+
+    /**
+      Creates an instance that is a function of the variables whose names
+      are specified in V and is specified by the std::string S.
+    */
+
+    CompactSymFun(const std::vector<std::string>& V, const std::string& S)
+    {
+        initialize();
+        initialize(SymFun(V,S));
+    }
+
+    /**
+      Creates an instance that is a function of the variables whose names
+      are specified in V, with symbolic constants C whose values are Cvalues,
+      and is specified by the std::string S.
+    */
+
+    CompactSymFun(const std::vector<std::string>& V, const std::vector<std::string>& C,
+                  const std::vector<double>& Cvalues, const std::string& S)
+    {
+        initialize();
+        initialize(SymFun(V,C,Cvalues,S));
+    }
+
+    CompactSymFun(const CompactSymFun& F)
+    {
+        initialize();
+        initialize(F);
+    }
+
+    CompactSymFun(CompactSymFun&& F) noexcept
+    {
+        initialize();
+        swap(F);
+    }
+
+    ~CompactSymFun()
+    {
+        destroy();
+    }
+
+    CompactSymFun& operator=(const CompactSymFun& F)
+    {
+        if(this != &F) initialize(F);
+        return *this;
+    }
+
+    CompactSymFun& operator=(CompactSymFun&& F) noexcept
+    {
+        if(this != &F)
+        {
+            destroy();
+            initialize();
+            swap(F);
+        }
+        return *this;
+    }
+
+    /**
+      Initializes the instance to a null instance.
+    */
+
+    void initialize()
+    {
+        expressionSize = 0;
+        codeSize       = 0;
+        literalCount   = 0;
+        temporaryCount = 0;
+        variableCount  = 0;
+        constantCount  = 0;
+        wideOperands   = 0;
+        heapStorage    = 0;
+        heapData       = 0;
+    }
+
+    /**
+      Initializes the instance to be a duplicate of F.
+    */
+
+    void initialize(const CompactSymFun& F)
+    {
+        if(this == &F) return;
+        destroy();
+
+        expressionSize = F.expressionSize;
+        codeSize       = F.codeSize;
+        literalCount   = F.literalCount;
+        temporaryCount = F.temporaryCount;
+        variableCount  = F.variableCount;
+        constantCount  = F.constantCount;
+        wideOperands   = F.wideOperands;
+        heapStorage    = 0;
+
+        unsigned char* data = allocateData();
+        memcpy(data, F.getData(), getDataSize());
+    }
+
+    /**
+      Initializes the instance to be a compact representation of F.
+    */
+
+    void initialize(const SymFun& F)
+    {
+        destroy();
+        initialize();
+        if(F.executionArraySize == 0) return;
+
+        if((F.variableCount > 0xFFFF)||(F.constantCount > 0xFFFF))
+        {
+            std::ostringstream errInfo;
+            errInfo << "Function has " << F.variableCount << " variables and " << F.constantCount
+                    << " symbolic constants, at most 65535 of each are supported";
+            throw SymFunException("Function too large for CompactSymFun",errInfo.str(),F.getConstructorString());
+        }
+
+        long symbolCount = F.symbolCount;
+
+        expressionSize = (uint32_t)strlen(F.constructorString);
+        variableCount  = (uint16_t)F.variableCount;
+        constantCount  = (uint16_t)F.constantCount;
+        literalCount   = (uint32_t)(symbolCount - F.variableCount - F.constantCount);
+        temporaryCount = (uint32_t)(F.evaluationDataSize - symbolCount);
+
+        long executionIndex = 0;
+        codeSize = 0;
+        while(executionIndex < F.executionArraySize)
+        {
+        long argCount   = F.executionArray[executionIndex + 1];
+        executionIndex += argCount + 2;
+        codeSize       += (uint32_t)(argCount + 1);
+        }
+
+        wideOperands = (F.evaluationDataSize > 0xFFFF) ? 1 : 0;
+
+        allocateData();
+    //
+    //  Values of the constants and numeric literals
+    //
+        double* pool = getPool();
+        long i;
+        for(i = 0; i < (long)constantCount; i++) {pool[i] = F.constantValues[i];}
+        for(i = 0; i < (long)literalCount;  i++)
+        {pool[constantCount + i] = F.program->initialData[F.variableCount + F.constantCount + i];}
+    //
+    //  Name ids
+    //
+        uint32_t* nameIds = getNameIds();
+        for(i = 0; i < (long)variableCount; i++)
+        {nameIds[i] = (uint32_t)F.program->variableIds[i];}
+        for(i = 0; i < (long)constantCount; i++)
+        {nameIds[variableCount + i] = (uint32_t)F.program->constantIds[i];}
+    //
+    //  Program
+    //
+        if(wideOperands) {createCode(F, getCode<uint32_t>());}
+        else             {createCode(F, getCode<uint16_t>());}
+    //
+    //  Expression string
+    //
+        memcpy(getExpression(), F.constructorString, expressionSize);
+    }
+
+    /**
+     Exchanges the data of the instance with that of F.
+    */
+
+    void swap(CompactSymFun& F) noexcept
+    {
+        CompactSymFun* A = this;
+        unsigned char tmp[sizeof(CompactSymFun)];
+        memcpy(tmp, (void*)A, sizeof(CompactSymFun));
+        memcpy((void*)A, (void*)&F, sizeof(CompactSymFun));
+        memcpy((void*)&F, tmp, sizeof(CompactSymFun));
+    }
+
+    //
+    //##################################################################
+    //                 EVALUATION OPERATORS
+    //##################################################################
+    //
+
+    double operator()(double x) const
+    {
+        if(variableCount != 1) argError(1, variableCount);
+        return evaluate<1>(&x);
+    }
+
+    double operator()(double x1, double x2) const
+    {
+        if(variableCount != 2) argError(2, variableCount);
+        double x[2] = {x1,x2};
+        return evaluate<2>(x);
+    }
+
+    double operator()(double x1, double x2, double x3) const
+    {
+        if(variableCount != 3) argError(3, variableCount);
+        double x[3] = {x1,x2,x3};
+        return evaluate<3>(x);
+    }
+
+    double operator()(double x1, double x2, double x3, double x4) const
+    {
+        if(variableCount != 4) argError(4, variableCount);
+        double x[4] = {x1,x2,x3,x4};
+        return evaluate<4>(x);
+    }
+
+    double operator()(const std::vector<double>& x) const
+    {
+        long n = (long)x.size();
+        if(variableCount != n) argError(n, variableCount);
+        return evaluate<-1>(&x[0]);
+    }
+
+    double operator()(const double* x, long n) const
+    {
+        if(variableCount != n) argError(n, variableCount);
+        return evaluate<-1>(x);
+    }
+
+    //
+    //##################################################################
+    //                 ACCESS
+    //##################################################################
+    //
+
+    /**
+     Returns an SCC::SymFun that evaluates the same function as the instance.
+    */
+
+    SymFun getSymFun() const
+    {
+        return SymFun(getVariableNames(),getConstantNames(),getConstantValues(),getConstructorString());
+    }
+
+    std::string getConstructorString() const
+    {
+        if(codeSize == 0) return std::string();
+        return std::string(getExpression(), expressionSize);
+    }
+
+    long getVariableCount() const
+    {
+        return (long)variableCount;
+    }
+
+    std::string getVariableName(long i) const
+    {
+        return std::string(SymFunSymbolTable::getSymbolName(getNameIds()[i]));
+    }
+
+    long getConstantCount() const
+    {
+        return (long)constantCount;
+    }
+
+    std::string getConstantName(long i) const
+    {
+        return std::string(SymFunSymbolTable::getSymbolName(getNameIds()[variableCount + i]));
+    }
+
+    double getConstantValue(long i) const
+    {
+        return getPool()[i];
+    }
+
+    double getConstantValue(const std::string& S) const
+    {
+        long i = getConstantIndex(S);
+        if(i >= 0) return getPool()[i];
+        return 0.0;
+    }
+
+    void setConstantValue(const std::string& S, double x)
+    {
+        long i = getConstantIndex(S);
+        if(i >= 0) getPool()[i] = x;
+    }
+
+    std::vector<std::string> getVariableNames() const
+    {
+        std::vector<std::string> V(variableCount);
+        for(long i = 0; i < (long)variableCount; i++) {V[i] = getVariableName(i);}
+        return V;
+    }
+
+    std::vector<std::string> getConstantNames() const
+    {
+        std::vector<std::string> C(constantCount);
+        for(long i = 0; i < (long)constantCount; i++) {C[i] = getConstantName(i);}
+        return C;
+    }
+
+    std::vector<double> getConstantValues() const
+    {
+        return std::vector<double>(getPool(), getPool() + constantCount);
+    }
+
+    /**
+     Returns the number of bytes used by the instance, including its heap
+     allocation if it has one. The interned variable and constant names, which
+     are shared by all instances, are not included.
+    */
+
+    size_t getByteSize() const
+    {
+        return sizeof(CompactSymFun) + (heapStorage ? getDataSize() : 0);
+    }
+
+protected:
+
+    //
+    // Data layout : [constant and literal values (double)][name ids (uint32_t)][program (uint16_t or uint32_t)]
+    //               [expression string (char, not null terminated)]
+    //
+    // Each operation of the program is an operator unit, (operator index) | (argument count << 8),
+    // followed by the operand units, which are indices into the evaluation data.
+    //
+
+    enum {localDataSize = 72, localFrameSize = 64};
+
+    void destroy()
+    {
+        if(heapStorage && (heapData != 0)) delete [] heapData;
+        heapStorage = 0;
+        heapData    = 0;
+    }
+
+    size_t getPoolSize() const
+    {
+        return (size_t)(constantCount + literalCount)*sizeof(double);
+    }
+
+    size_t getNameIdSize() const
+    {
+        return (size_t)(variableCount + constantCount)*sizeof(uint32_t);
+    }
+
+    size_t getDataSize() const
+    {
+        return getPoolSize() + getNameIdSize() + getCodeSize() + expressionSize;
+    }
+
+    size_t getCodeSize() const
+    {
+        size_t codeUnitSize = wideOperands ? sizeof(uint32_t) : sizeof(uint16_t);
+        return codeSize*codeUnitSize;
+    }
+
+    unsigned char* allocateData()
+    {
+        size_t dataSize = getDataSize();
+        heapStorage = (dataSize > (size_t)localDataSize) ? 1 : 0;
+        if(heapStorage) {heapData = new unsigned char[dataSize];}
+        return getData();
+    }
+
+    unsigned char* getData()
+    {
+        return heapStorage ? heapData : localData;
+    }
+
+    const unsigned char* getData() const
+    {
+        return heapStorage ? heapData : localData;
+    }
+
+    double* getPool()
+    {
+        return (double*)getData();
+    }
+
+    const double* getPool() const
+    {
+        return (const double*)getData();
+    }
+
+    uint32_t* getNameIds()
+    {
+        return (uint32_t*)(getData() + getPoolSize());
+    }
+
+    const uint32_t* getNameIds() const
+    {
+        return (const uint32_t*)(getData() + getPoolSize());
+    }
+
+    template <class U>
+    U* getCode()
+    {
+        return (U*)(getData() + getPoolSize() + getNameIdSize());
+    }
+
+    template <class U>
+    const U* getCode() const
+    {
+        return (const U*)(getData() + getPoolSize() + getNameIdSize());
+    }
+
+    char* getExpression()
+    {
+        return (char*)(getData() + getPoolSize() + getNameIdSize() + getCodeSize());
+    }
+
+    const char* getExpression() const
+    {
+        return (const char*)(getData() + getPoolSize() + getNameIdSize() + getCodeSize());
+    }
+
+    long getConstantIndex(const std::string& S) const
+    {
+        long id = SymFunSymbolTable::findSymbolId(S);
+        if(id < 0) return -1;
+
+        const uint32_t* nameIds = getNameIds();
+        for(long i = 0; i < (long)constantCount; i++)
+        {
+        if(nameIds[variableCount + i] == (uint32_t)id) return i;
+        }
+        return -1;
+    }
+
+    //
+    // Converts the execution array of F to the compact program code
+    //
+
+    template <class U>
+    void createCode(const SymFun& F, U* code) const
+    {
+        long executionIndex = 0;
+        while(executionIndex < F.executionArraySize)
+        {
+        long functionIndex = F.executionArray[executionIndex]; executionIndex++;
+        long argCount      = F.executionArray[executionIndex]; executionIndex++;
+
+        *code++ = (U)(functionIndex | (argCount << 8));
+
+        for(long j = 0; j < argCount; j++)
+        {
+            *code++ = (U)F.executionArray[executionIndex]; executionIndex++;
+        }
+        }
+    }
+
+    //
+    // Evaluates the function. The evaluation data, the variable values followed by the
+    // values of the constants, literals and temporaries, is assembled in a frame on the
+    // stack, or, for large programs, in a buffer of the evaluating thread that is reused by
+    // subsequent evaluations. N is the number of variables when it is known at compile
+    // time and -1 otherwise.
+    //
+
+    template <long N>
+    double evaluate(const double* x) const
+    {
+        long frameSize = getFrameSize();
+        if(frameSize > (long)localFrameSize) return evaluateLarge(x);
+
+        double frame[localFrameSize];
+
+        if(N >= 0) {for(long i = 0; i < N; i++)                   {frame[i] = x[i];}}
+        else       {for(long i = 0; i < (long)variableCount; i++) {frame[i] = x[i];}}
+
+        const double* pool      = getPool();
+        long          poolCount = (long)constantCount + (long)literalCount;
+        for(long i = 0; i < poolCount; i++) {frame[variableCount + i] = pool[i];}
+
+        if(wideOperands) {execute(getCode<uint32_t>(),frame);}
+        else             {execute(getCode<uint16_t>(),frame);}
+
+        return frame[frameSize - 1];
+    }
+
+    double evaluateLarge(const double* x) const
+    {
+        static thread_local std::vector<double> frame;
+
+        long frameSize = getFrameSize();
+        if((long)frame.size() < frameSize) frame.resize(frameSize);
+
+        const double* pool      = getPool();
+        long          poolCount = (long)constantCount + (long)literalCount;
+        long i;
+        for(i = 0; i < (long)variableCount; i++) {frame[i] = x[i];}
+        for(i = 0; i < poolCount; i++)           {frame[variableCount + i] = pool[i];}
+
+        if(wideOperands) {execute(getCode<uint32_t>(),&frame[0]);}
+        else             {execute(getCode<uint16_t>(),&frame[0]);}
+
+        return frame[frameSize - 1];
+    }
+
+    long getFrameSize() const
+    {
+        return (long)variableCount + (long)constantCount + (long)literalCount + (long)temporaryCount;
+    }
+
+    //
+    // Executes the program using frame as the evaluation data
+    //
+
+    template <class U>
+    void execute(const U* code, double* frame) const
+    {
+        void* const* LibFunctions = RealOperatorLib::getFunctionArray();
+
+        double* argData[10];   // limit of 10 args for now
+
+        const U* codeEnd = code + codeSize;
+        while(code < codeEnd)
+        {
+        long functionIndex = (long)(*code & 0xFF);
+        long argCount      = (long)(*code >> 8);
+        code++;
+        for(long j = 0; j < argCount; j++)
+        {
+        argData[j] = frame + *code;
+        code++;
+        }
+        ((void(*)(double**))LibFunctions[functionIndex])(argData);
+        }
+    }
+
+    void argError(long argC, long vCount) const
+    {
+        (void)argC; (void)vCount;
+        #ifdef _DEBUG
+        std::cerr << " Incorrect Number of Arguments in CompactSymFun " << std::endl;
+        std::cerr << " Called with " << argC << " arguments, expecting " << vCount;
+        std::cerr << " Fatal Error : Program Stopped " << std::endl;
+        exit(1);
+        #endif
+    }
+
+    uint32_t expressionSize;   // number of characters of the expression string
+    uint32_t codeSize;         // number of units in the program
+    uint32_t literalCount;
+    uint32_t temporaryCount;
+    uint16_t variableCount;
+    uint16_t constantCount;
+    uint8_t  wideOperands;     // 1 if the program units are 32 bit
+    uint8_t  heapStorage;      // 1 if the data is in heapData
+
+    union
+    {
+    alignas(double) unsigned char localData[localDataSize];
+    unsigned char*                heapData;
+    };
+};
+
+inline void swap(CompactSymFun& A, CompactSymFun& B) noexcept
+{
+    A.swap(B);
+}
+
+}
+#endif
@@ -0,0 +1,336 @@
+//
+//##################################################################
+//                     SCC_LazySymFun.h
+//##################################################################
+//
+// A class whose instances hold the specification of an SCC::SymFun
+// and compile it when it is first evaluated.
+//
+// Chris Anderson (C) UCLA 2022
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "SCC_SymFun.h"
+#include "SCC_SymFunEvaluationPlan.h"
+
+#ifndef LAZY_SYMFUN_
+#define LAZY_SYMFUN_
+
+namespace SCC
+{
+
+/*!
+ \class SCC::LazySymFun
+ \brief A class for SCC::SymFun instances that are compiled when first evaluated
+
+ An SCC::LazySymFun is created from the same specification as an SCC::SymFun (variable names,
+ symbolic constant names and values and the function string), but the specification is only stored;
+ the function is parsed and compiled the first time it is evaluated, or when precompile() or
+ getSymFun() is invoked. Applications that define many functions, only some of which are used,
+ only pay for compiling the functions that are used.
+
+ Compilation is carried out once, even when the first evaluations of an instance, or of copies of an
+ instance, take place in several threads at once: copies share the specification and the compiled program.
+ Syntax errors generate an SCC::SymFunException when the function is compiled; precompile() can
+ be used to compile a function (and report errors) before latency critical use.
+
+ Setting the value of a symbolic constant compiles the function. As with SCC::SymFun, the
+ evaluation operators of an instance should not be used by more than one thread at a time,
+ while evaluateBatch(...) may be invoked concurrently.
+
+ Sample:
+ \code
+    SCC::LazySymFun F({"x","y"},{"a"},{2.0},"a*x^2 + y^2");  // no compilation
+
+    F.precompile();                                           // optional
+
+    double f = F(1.0,2.0);                                    // compiled here if not precompiled
+ \endcode
+
+ \headerfile SCC_LazySymFun.h "SCC_LazySymFun.h"
+*/
+
+class LazySymFun
+{
+public:
+
+    /**
+      Null constructor. The instance created must be initialized with
+      one of the initialize(...) member functions.
+    */
+
+    LazySymFun() : attached(false)
+    {}
+
+    LazySymFun(const std::string& S) : attached(false)
+    {
+        initialize(S);
+    }
+
+    LazySymFun(const std::vector<std::string>& V, const std::string& S) : attached(false)
+    {
+        initialize(V,S);
+    }
+
+    LazySymFun(const std::vector<std::string>& V, const std::vector<std::string>& C,
+               const std::vector<double>& Cvalues, const std::string& S) : attached(false)
+    {
+        initialize(V,C,Cvalues,S);
+    }
+
+    // Copies share the specification and compiled program. A copy of a compiled
+    // instance copies its constant values.
+
+    LazySymFun(const LazySymFun& G) : attached(false)
+    {
+        copy(G);
+    }
+
+    LazySymFun& operator=(const LazySymFun& G)
+    {
+        if(this != &G)
+        {
+            attached.store(false);
+            F.initialize();
+            copy(G);
+        }
+        return *this;
+    }
+
+    /**
+      Stores the specification of a function of the variable x.
+    */
+
+    void initialize(const std::string& S)
+    {
+        initialize(std::vector<std::string>(1,"x"),S);
+    }
+
+    void initialize(const std::vector<std::string>& V, const std::string& S)
+    {
+        initialize(V,std::vector<std::string>(),std::vector<double>(),S);
+    }
+
+    /**
+      Stores the specification of the function S of the variables V and the symbolic
+      constants C with initial values Cvalues. The function is not compiled.
+    */
+
+    void initialize(const std::vector<std::string>& V, const std::vector<std::string>& C,
+                    const std::vector<double>& Cvalues, const std::string& S)
+    {
+        spec = std::make_shared<Specification>();
+        spec->V       = V;
+        spec->C       = C;
+        spec->Cvalues = Cvalues;
+        spec->S       = S;
+
+        attached.store(false);
+        F.initialize();
+    }
+
+    /**
+     Compiles the function if it has not been compiled. Syntax errors generate
+     an SCC::SymFunException.
+    */
+
+    void precompile() const
+    {
+        if((!spec)||attached.load(std::memory_order_acquire)) return;
+        attachProgram();
+    }
+
+    /**
+     Returns true if the function has been compiled, by this instance or a copy.
+    */
+
+    bool isCompiled() const
+    {
+        return spec && spec->compiled.load();
+    }
+
+    double operator()(double x) const
+    {
+        precompile();
+        return F(x);
+    }
+
+    double operator()(double x1, double x2) const
+    {
+        precompile();
+        return F(x1,x2);
+    }
+
+    double operator()(double x1, double x2, double x3) const
+    {
+        precompile();
+        return F(x1,x2,x3);
+    }
+
+    double operator()(double x1, double x2, double x3, double x4) const
+    {
+        precompile();
+        return F(x1,x2,x3,x4);
+    }
+
+    double operator()(const std::vector<double>& x) const
+    {
+        precompile();
+        return F(x);
+    }
+
+    /**
+     Evaluates the function at n points; see SCC::SymFun::evaluateBatch(...).
+    */
+
+    template<class T>
+    void evaluateBatch(const T* const* x, long n, T* f) const
+    {
+        precompile();
+        F.evaluateBatch(x,n,f);
+    }
+
+    template<class T>
+    void evaluateBatch(const T* const* x, long n, T* f, const SymFunEvaluationPlan& plan) const
+    {
+        precompile();
+        F.evaluateBatch(x,n,f,plan);
+    }
+
+    // The specification is available without compiling the function
+
+    std::string getConstructorString() const
+    {
+        return spec ? spec->S : std::string();
+    }
+
+    long getVariableCount() const
+    {
+        return spec ? (long)spec->V.size() : 0;
+    }
+
+    std::vector<std::string> getVariableNames() const
+    {
+        return spec ? spec->V : std::vector<std::string>();
+    }
+
+    long getConstantCount() const
+    {
+        return spec ? (long)spec->C.size() : 0;
+    }
+
+    std::vector<std::string> getConstantNames() const
+    {
+        return spec ? spec->C : std::vector<std::string>();
+    }
+
+    double getConstantValue(const std::string& C) const
+    {
+        precompile();
+        return F.getConstantValue(C);
+    }
+
+    void setConstantValue(const std::string& C, double x)
+    {
+        precompile();
+        F.setConstantValue(C,x);
+    }
+
+    /**
+     Returns the compiled SCC::SymFun, compiling it if required.
+    */
+
+    const SymFun& getSymFun() const
+    {
+        precompile();
+        return F;
+    }
+
+protected:
+
+    //
+    // The specification and the program compiled from it, shared by copies.
+    //
+
+    class Specification
+    {
+    public:
+
+        Specification() : compiled(false) {}
+
+        void compile()
+        {
+            if(C.empty()) {F.initialize(V,S);}
+            else          {F.initialize(V,C,Cvalues,S);}
+            compiled.store(true,std::memory_order_release);
+        }
+
+        std::vector<std::string> V;
+        std::vector<std::string> C;
+        std::vector<double>      Cvalues;
+        std::string              S;
+
+        std::mutex               compileMutex;
+        std::atomic<bool>        compiled;
+        SymFun                   F;
+    };
+
+    //
+    // Compiles the shared specification (once) and sets F to share its program.
+    // The flags are checked again holding the lock of the specification, so threads
+    // that evaluate the instance, or copies of it, for the first time at once compile
+    // the specification once. If compilation throws, neither flag is set (and the lock
+    // is released), so compilation is attempted again on the next evaluation.
+    //
+
+    void attachProgram() const
+    {
+        std::lock_guard<std::mutex> lock(spec->compileMutex);
+        if(attached.load(std::memory_order_relaxed)) return;
+
+        if(!spec->compiled.load(std::memory_order_relaxed)) spec->compile();
+
+        F = spec->F;
+        attached.store(true,std::memory_order_release);
+    }
+
+    void copy(const LazySymFun& G)
+    {
+        spec = G.spec;
+        if(G.attached.load(std::memory_order_acquire))
+        {
+            F = G.F;
+            attached.store(true);
+        }
+    }
+
+    std::shared_ptr<Specification>  spec;
+    mutable std::atomic<bool>       attached;   // true once F shares the compiled program
+    mutable SymFun                  F;
+};
+}
+#endif
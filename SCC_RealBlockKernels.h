@@ -0,0 +1,306 @@
+//
+//##################################################################
+//                   SCC_RealBlockKernels.h
+//##################################################################
+//
+// Vectorized versions of the block operators of SCC::RealOperatorLib
+// compiled for several instruction set levels (SSE2, AVX2, AVX-512)
+// and for double and float values.
+// The variant used is selected at run time by SCC::RealOperatorLib
+// based upon the features of the CPU, so a single binary uses the widest
+// vector instructions available on each node.
+//
+// Only operators whose vector instructions are correctly rounded are
+// vectorized (+, -, *, /, abs, sqrt), so the results are identical
+// for all instruction set levels and identical to those of the scalar
+// interpreter. The remaining operators use the generic block operators.
+// Fused multiply-add instructions are not used, since they round
+// differently from a multiplication followed by an addition.
+//
+// Chris Anderson (C) UCLA 2022
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <cmath>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define SCC_X86_KERNELS_
+#include <immintrin.h>
+#define SCC_TARGET_SSE2
+#define SCC_TARGET_AVX2
+#define SCC_TARGET_AVX512
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SCC_X86_KERNELS_
+#include <immintrin.h>
+#define SCC_TARGET_SSE2   __attribute__((target("sse2")))
+#define SCC_TARGET_AVX2   __attribute__((target("avx2")))
+#define SCC_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+#ifndef REAL_BLOCK_KERNELS_
+#define REAL_BLOCK_KERNELS_
+
+#ifdef SCC_X86_KERNELS_
+
+//
+// Kernel generators. VLOAD, VSTORE and VOP are the vector load, store and operation,
+// WIDTH the number of values of type TYPE per vector register. The remainder of each block
+// is processed with the scalar operation.
+//
+
+#define SCC_BINARY_KERNEL(NAME,TARGET,TYPE,WIDTH,VLOAD,VSTORE,VOP,SOP)    \
+    TARGET static void NAME(TYPE** const argPtr, long n)                  \
+    {                                                                     \
+        const TYPE* a = argPtr[0]; const TYPE* b = argPtr[1];             \
+        TYPE*       r = argPtr[2];                                        \
+        long k = 0;                                                       \
+        for(; k + WIDTH <= n; k += WIDTH)                                 \
+        {VSTORE(r + k,VOP(VLOAD(a + k),VLOAD(b + k)));}                   \
+        for(; k < n; ++k) {r[k] = a[k] SOP b[k];}                         \
+    }
+
+#define SCC_UNARY_KERNEL(NAME,TARGET,TYPE,WIDTH,VLOAD,VSTORE,VOP,SFUN)    \
+    TARGET static void NAME(TYPE** const argPtr, long n)                  \
+    {                                                                     \
+        const TYPE* a = argPtr[0];                                        \
+        TYPE*       r = argPtr[1];                                        \
+        long k = 0;                                                       \
+        for(; k + WIDTH <= n; k += WIDTH)                                 \
+        {VSTORE(r + k,VOP(VLOAD(a + k)));}                                \
+        for(; k < n; ++k) {r[k] = SFUN(a[k]);}                            \
+    }
+
+#endif
+
+namespace SCC
+{
+class RealBlockKernels
+{
+public :
+
+#ifdef SCC_X86_KERNELS_
+
+//
+//  Scalar operations used for the remainder of each block
+//
+    static double scalarPlus(double x)  {return +x;}
+    static double scalarMinus(double x) {return -x;}
+    static double scalarAbs(double x)   {return std::abs(x);}
+    static double scalarSqrt(double x)  {return std::sqrt(x);}
+
+    static float scalarPlusf(float x)   {return +x;}
+    static float scalarMinusf(float x)  {return -x;}
+    static float scalarAbsf(float x)    {return std::abs(x);}
+    static float scalarSqrtf(float x)   {return std::sqrt(x);}
+
+//
+//  SSE2 (2 doubles)
+//
+    SCC_TARGET_SSE2 static __m128d plusSSE2(__m128d x)  {return x;}
+    SCC_TARGET_SSE2 static __m128d minusSSE2(__m128d x) {return _mm_xor_pd(x,_mm_set1_pd(-0.0));}
+    SCC_TARGET_SSE2 static __m128d absSSE2(__m128d x)   {return _mm_andnot_pd(_mm_set1_pd(-0.0),x);}
+
+    SCC_UNARY_KERNEL(PlusSSE2,     SCC_TARGET_SSE2,double,2,_mm_loadu_pd,_mm_storeu_pd,plusSSE2, scalarPlus)
+    SCC_UNARY_KERNEL(MinusSSE2,    SCC_TARGET_SSE2,double,2,_mm_loadu_pd,_mm_storeu_pd,minusSSE2,scalarMinus)
+    SCC_BINARY_KERNEL(AddSSE2,     SCC_TARGET_SSE2,double,2,_mm_loadu_pd,_mm_storeu_pd,_mm_add_pd,+)
+    SCC_BINARY_KERNEL(SubtractSSE2,SCC_TARGET_SSE2,double,2,_mm_loadu_pd,_mm_storeu_pd,_mm_sub_pd,-)
+    SCC_BINARY_KERNEL(TimesSSE2,   SCC_TARGET_SSE2,double,2,_mm_loadu_pd,_mm_storeu_pd,_mm_mul_pd,*)
+    SCC_BINARY_KERNEL(DivideSSE2,  SCC_TARGET_SSE2,double,2,_mm_loadu_pd,_mm_storeu_pd,_mm_div_pd,/)
+    SCC_UNARY_KERNEL(AbsSSE2,      SCC_TARGET_SSE2,double,2,_mm_loadu_pd,_mm_storeu_pd,absSSE2,  scalarAbs)
+    SCC_UNARY_KERNEL(SqrtSSE2,     SCC_TARGET_SSE2,double,2,_mm_loadu_pd,_mm_storeu_pd,_mm_sqrt_pd,scalarSqrt)
+
+//
+//  AVX2 (4 doubles)
+//
+    SCC_TARGET_AVX2 static __m256d plusAVX2(__m256d x)  {return x;}
+    SCC_TARGET_AVX2 static __m256d minusAVX2(__m256d x) {return _mm256_xor_pd(x,_mm256_set1_pd(-0.0));}
+    SCC_TARGET_AVX2 static __m256d absAVX2(__m256d x)   {return _mm256_andnot_pd(_mm256_set1_pd(-0.0),x);}
+
+    SCC_UNARY_KERNEL(PlusAVX2,     SCC_TARGET_AVX2,double,4,_mm256_loadu_pd,_mm256_storeu_pd,plusAVX2, scalarPlus)
+    SCC_UNARY_KERNEL(MinusAVX2,    SCC_TARGET_AVX2,double,4,_mm256_loadu_pd,_mm256_storeu_pd,minusAVX2,scalarMinus)
+    SCC_BINARY_KERNEL(AddAVX2,     SCC_TARGET_AVX2,double,4,_mm256_loadu_pd,_mm256_storeu_pd,_mm256_add_pd,+)
+    SCC_BINARY_KERNEL(SubtractAVX2,SCC_TARGET_AVX2,double,4,_mm256_loadu_pd,_mm256_storeu_pd,_mm256_sub_pd,-)
+    SCC_BINARY_KERNEL(TimesAVX2,   SCC_TARGET_AVX2,double,4,_mm256_loadu_pd,_mm256_storeu_pd,_mm256_mul_pd,*)
+    SCC_BINARY_KERNEL(DivideAVX2,  SCC_TARGET_AVX2,double,4,_mm256_loadu_pd,_mm256_storeu_pd,_mm256_div_pd,/)
+    SCC_UNARY_KERNEL(AbsAVX2,      SCC_TARGET_AVX2,double,4,_mm256_loadu_pd,_mm256_storeu_pd,absAVX2,  scalarAbs)
+    SCC_UNARY_KERNEL(SqrtAVX2,     SCC_TARGET_AVX2,double,4,_mm256_loadu_pd,_mm256_storeu_pd,_mm256_sqrt_pd,scalarSqrt)
+
+//
+//  AVX-512 (8 doubles). Only AVX512F instructions are used, so the
+//  sign bit operations are carried out with integer instructions.
+//
+    SCC_TARGET_AVX512 static __m512d plusAVX512(__m512d x)  {return x;}
+    SCC_TARGET_AVX512 static __m512d minusAVX512(__m512d x)
+    {return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(x),_mm512_set1_epi64((long long)0x8000000000000000ULL)));}
+    SCC_TARGET_AVX512 static __m512d absAVX512(__m512d x)
+    {return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(x),_mm512_set1_epi64((long long)0x7FFFFFFFFFFFFFFFULL)));}
+    SCC_TARGET_AVX512 static __m512d sqrtAVX512(__m512d x)  {return _mm512_maskz_sqrt_pd((__mmask8)0xFF,x);}
+
+    SCC_UNARY_KERNEL(PlusAVX512,     SCC_TARGET_AVX512,double,8,_mm512_loadu_pd,_mm512_storeu_pd,plusAVX512, scalarPlus)
+    SCC_UNARY_KERNEL(MinusAVX512,    SCC_TARGET_AVX512,double,8,_mm512_loadu_pd,_mm512_storeu_pd,minusAVX512,scalarMinus)
+    SCC_BINARY_KERNEL(AddAVX512,     SCC_TARGET_AVX512,double,8,_mm512_loadu_pd,_mm512_storeu_pd,_mm512_add_pd,+)
+    SCC_BINARY_KERNEL(SubtractAVX512,SCC_TARGET_AVX512,double,8,_mm512_loadu_pd,_mm512_storeu_pd,_mm512_sub_pd,-)
+    SCC_BINARY_KERNEL(TimesAVX512,   SCC_TARGET_AVX512,double,8,_mm512_loadu_pd,_mm512_storeu_pd,_mm512_mul_pd,*)
+    SCC_BINARY_KERNEL(DivideAVX512,  SCC_TARGET_AVX512,double,8,_mm512_loadu_pd,_mm512_storeu_pd,_mm512_div_pd,/)
+    SCC_UNARY_KERNEL(AbsAVX512,      SCC_TARGET_AVX512,double,8,_mm512_loadu_pd,_mm512_storeu_pd,absAVX512,  scalarAbs)
+    SCC_UNARY_KERNEL(SqrtAVX512,     SCC_TARGET_AVX512,double,8,_mm512_loadu_pd,_mm512_storeu_pd,sqrtAVX512, scalarSqrt)
+
+//
+//  SSE2 (4 floats)
+//
+    SCC_TARGET_SSE2 static __m128 plusSSE2f(__m128 x)  {return x;}
+    SCC_TARGET_SSE2 static __m128 minusSSE2f(__m128 x) {return _mm_xor_ps(x,_mm_set1_ps(-0.0f));}
+    SCC_TARGET_SSE2 static __m128 absSSE2f(__m128 x)   {return _mm_andnot_ps(_mm_set1_ps(-0.0f),x);}
+
+    SCC_UNARY_KERNEL(PlusSSE2f,     SCC_TARGET_SSE2,float,4,_mm_loadu_ps,_mm_storeu_ps,plusSSE2f, scalarPlusf)
+    SCC_UNARY_KERNEL(MinusSSE2f,    SCC_TARGET_SSE2,float,4,_mm_loadu_ps,_mm_storeu_ps,minusSSE2f,scalarMinusf)
+    SCC_BINARY_KERNEL(AddSSE2f,     SCC_TARGET_SSE2,float,4,_mm_loadu_ps,_mm_storeu_ps,_mm_add_ps,+)
+    SCC_BINARY_KERNEL(SubtractSSE2f,SCC_TARGET_SSE2,float,4,_mm_loadu_ps,_mm_storeu_ps,_mm_sub_ps,-)
+    SCC_BINARY_KERNEL(TimesSSE2f,   SCC_TARGET_SSE2,float,4,_mm_loadu_ps,_mm_storeu_ps,_mm_mul_ps,*)
+    SCC_BINARY_KERNEL(DivideSSE2f,  SCC_TARGET_SSE2,float,4,_mm_loadu_ps,_mm_storeu_ps,_mm_div_ps,/)
+    SCC_UNARY_KERNEL(AbsSSE2f,      SCC_TARGET_SSE2,float,4,_mm_loadu_ps,_mm_storeu_ps,absSSE2f,  scalarAbsf)
+    SCC_UNARY_KERNEL(SqrtSSE2f,     SCC_TARGET_SSE2,float,4,_mm_loadu_ps,_mm_storeu_ps,_mm_sqrt_ps,scalarSqrtf)
+
+//
+//  AVX2 (8 floats)
+//
+    SCC_TARGET_AVX2 static __m256 plusAVX2f(__m256 x)  {return x;}
+    SCC_TARGET_AVX2 static __m256 minusAVX2f(__m256 x) {return _mm256_xor_ps(x,_mm256_set1_ps(-0.0f));}
+    SCC_TARGET_AVX2 static __m256 absAVX2f(__m256 x)   {return _mm256_andnot_ps(_mm256_set1_ps(-0.0f),x);}
+
+    SCC_UNARY_KERNEL(PlusAVX2f,     SCC_TARGET_AVX2,float,8,_mm256_loadu_ps,_mm256_storeu_ps,plusAVX2f, scalarPlusf)
+    SCC_UNARY_KERNEL(MinusAVX2f,    SCC_TARGET_AVX2,float,8,_mm256_loadu_ps,_mm256_storeu_ps,minusAVX2f,scalarMinusf)
+    SCC_BINARY_KERNEL(AddAVX2f,     SCC_TARGET_AVX2,float,8,_mm256_loadu_ps,_mm256_storeu_ps,_mm256_add_ps,+)
+    SCC_BINARY_KERNEL(SubtractAVX2f,SCC_TARGET_AVX2,float,8,_mm256_loadu_ps,_mm256_storeu_ps,_mm256_sub_ps,-)
+    SCC_BINARY_KERNEL(TimesAVX2f,   SCC_TARGET_AVX2,float,8,_mm256_loadu_ps,_mm256_storeu_ps,_mm256_mul_ps,*)
+    SCC_BINARY_KERNEL(DivideAVX2f,  SCC_TARGET_AVX2,float,8,_mm256_loadu_ps,_mm256_storeu_ps,_mm256_div_ps,/)
+    SCC_UNARY_KERNEL(AbsAVX2f,      SCC_TARGET_AVX2,float,8,_mm256_loadu_ps,_mm256_storeu_ps,absAVX2f,  scalarAbsf)
+    SCC_UNARY_KERNEL(SqrtAVX2f,     SCC_TARGET_AVX2,float,8,_mm256_loadu_ps,_mm256_storeu_ps,_mm256_sqrt_ps,scalarSqrtf)
+
+//
+//  AVX-512 (16 floats)
+//
+    SCC_TARGET_AVX512 static __m512 plusAVX512f(__m512 x)  {return x;}
+    SCC_TARGET_AVX512 static __m512 minusAVX512f(__m512 x)
+    {return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(x),_mm512_set1_epi32((int)0x80000000U)));}
+    SCC_TARGET_AVX512 static __m512 absAVX512f(__m512 x)
+    {return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(x),_mm512_set1_epi32(0x7FFFFFFF)));}
+    SCC_TARGET_AVX512 static __m512 sqrtAVX512f(__m512 x)  {return _mm512_maskz_sqrt_ps((__mmask16)0xFFFF,x);}
+
+    SCC_UNARY_KERNEL(PlusAVX512f,     SCC_TARGET_AVX512,float,16,_mm512_loadu_ps,_mm512_storeu_ps,plusAVX512f, scalarPlusf)
+    SCC_UNARY_KERNEL(MinusAVX512f,    SCC_TARGET_AVX512,float,16,_mm512_loadu_ps,_mm512_storeu_ps,minusAVX512f,scalarMinusf)
+    SCC_BINARY_KERNEL(AddAVX512f,     SCC_TARGET_AVX512,float,16,_mm512_loadu_ps,_mm512_storeu_ps,_mm512_add_ps,+)
+    SCC_BINARY_KERNEL(SubtractAVX512f,SCC_TARGET_AVX512,float,16,_mm512_loadu_ps,_mm512_storeu_ps,_mm512_sub_ps,-)
+    SCC_BINARY_KERNEL(TimesAVX512f,   SCC_TARGET_AVX512,float,16,_mm512_loadu_ps,_mm512_storeu_ps,_mm512_mul_ps,*)
+    SCC_BINARY_KERNEL(DivideAVX512f,  SCC_TARGET_AVX512,float,16,_mm512_loadu_ps,_mm512_storeu_ps,_mm512_div_ps,/)
+    SCC_UNARY_KERNEL(AbsAVX512f,      SCC_TARGET_AVX512,float,16,_mm512_loadu_ps,_mm512_storeu_ps,absAVX512f,  scalarAbsf)
+    SCC_UNARY_KERNEL(SqrtAVX512f,     SCC_TARGET_AVX512,float,16,_mm512_loadu_ps,_mm512_storeu_ps,sqrtAVX512f, scalarSqrtf)
+
+#endif
+
+//
+//  Replaces the entries of the block function array of SCC::RealOperatorLib
+//  for the vectorized operators with the kernels for the specified
+//  instruction set level (0 = generic, 1 = SSE2, 2 = AVX2, 3 = AVX-512).
+//
+    static void setBlockFunctions(void** blockFunctionArray, long instructionSetLevel)
+    {
+#ifdef SCC_X86_KERNELS_
+    	if(instructionSetLevel >= 3)
+    	{
+    	void* kernels[] = {(void*)PlusAVX512,(void*)MinusAVX512,(void*)AddAVX512,(void*)SubtractAVX512,
+    	                   (void*)TimesAVX512,(void*)DivideAVX512,(void*)AbsAVX512,(void*)SqrtAVX512};
+    	setKernels(blockFunctionArray,kernels);
+    	}
+    	else if(instructionSetLevel == 2)
+    	{
+    	void* kernels[] = {(void*)PlusAVX2,(void*)MinusAVX2,(void*)AddAVX2,(void*)SubtractAVX2,
+    	                   (void*)TimesAVX2,(void*)DivideAVX2,(void*)AbsAVX2,(void*)SqrtAVX2};
+    	setKernels(blockFunctionArray,kernels);
+    	}
+    	else if(instructionSetLevel == 1)
+    	{
+    	void* kernels[] = {(void*)PlusSSE2,(void*)MinusSSE2,(void*)AddSSE2,(void*)SubtractSSE2,
+    	                   (void*)TimesSSE2,(void*)DivideSSE2,(void*)AbsSSE2,(void*)SqrtSSE2};
+    	setKernels(blockFunctionArray,kernels);
+    	}
+#else
+    	(void)blockFunctionArray;
+    	(void)instructionSetLevel;
+#endif
+    }
+
+//
+//  The float version of setBlockFunctions(...)
+//
+    static void setFloatBlockFunctions(void** blockFunctionArray, long instructionSetLevel)
+    {
+#ifdef SCC_X86_KERNELS_
+    	if(instructionSetLevel >= 3)
+    	{
+    	void* kernels[] = {(void*)PlusAVX512f,(void*)MinusAVX512f,(void*)AddAVX512f,(void*)SubtractAVX512f,
+    	                   (void*)TimesAVX512f,(void*)DivideAVX512f,(void*)AbsAVX512f,(void*)SqrtAVX512f};
+    	setKernels(blockFunctionArray,kernels);
+    	}
+    	else if(instructionSetLevel == 2)
+    	{
+    	void* kernels[] = {(void*)PlusAVX2f,(void*)MinusAVX2f,(void*)AddAVX2f,(void*)SubtractAVX2f,
+    	                   (void*)TimesAVX2f,(void*)DivideAVX2f,(void*)AbsAVX2f,(void*)SqrtAVX2f};
+    	setKernels(blockFunctionArray,kernels);
+    	}
+    	else if(instructionSetLevel == 1)
+    	{
+    	void* kernels[] = {(void*)PlusSSE2f,(void*)MinusSSE2f,(void*)AddSSE2f,(void*)SubtractSSE2f,
+    	                   (void*)TimesSSE2f,(void*)DivideSSE2f,(void*)AbsSSE2f,(void*)SqrtSSE2f};
+    	setKernels(blockFunctionArray,kernels);
+    	}
+#else
+    	(void)blockFunctionArray;
+    	(void)instructionSetLevel;
+#endif
+    }
+
+private :
+
+//
+//  Indices of the vectorized operators in the operator table of SCC::RealOperatorLib
+//
+    static void setKernels(void** blockFunctionArray, void** kernels)
+    {
+    	const long kernelIndex[] = {0,1,2,3,4,5,19,24};
+    	for(long i = 0; i < 8; i++) {blockFunctionArray[kernelIndex[i]] = kernels[i];}
+    }
+};
+}
+
+#ifdef SCC_X86_KERNELS_
+#undef SCC_BINARY_KERNEL
+#undef SCC_UNARY_KERNEL
+#endif
+
+#endif
+
+// The target attributes are defined before the include guard, so they are
+// removed after it each time this header is included.
+
+#undef SCC_TARGET_SSE2
+#undef SCC_TARGET_AVX2
+#undef SCC_TARGET_AVX512
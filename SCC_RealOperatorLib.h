@@ -26,98 +26,115 @@
 #############################################################################
 */
 #include <cstring>
+#include <cstdlib>
 #include <cmath>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+
 #include "SCC_OperatorLib.h"
+#include "SCC_RealBlockKernels.h"
 
 #ifndef REAL_OPERATOR_LIB_
 #define REAL_OPERATOR_LIB_
 
 namespace SCC
 {
-class  RealOperatorLib : public SCC::OperatorLib
+//
+//  The operator tables of SCC::RealOperatorLib. The tables are static constexpr
+//  data shared by all instances; the class template is used so the out-of-class
+//  definitions required by C++11 can be placed in this header.
+//
+template <class Dummy>
+class RealOperatorTable
+{
+public :
+
+    constexpr static long  operatorCount = 26;
+
+    constexpr static const char* Symbols[26] =
+    {"+", "-", "+", "-", "*", "/","^","sin", "cos",
+    "tan","asin","acos","atan","atan2",
+    "sinh","cosh","tanh",
+    "ceil","exp","abs","floor","fmod","log","log10","sqrt","pow"};
+
+    constexpr static long Priority[26] =
+    {3,3,5,5,4,4,2,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1};
+
+    constexpr static long ArgCount[26] =
+    {1,1,2,2,2,2,2,1,1,1,1,1,1,2,1,1,1,1,1,1,1,2,1,1,1,2};
+};
+
+template <class Dummy> constexpr long        RealOperatorTable<Dummy>::operatorCount;
+template <class Dummy> constexpr const char* RealOperatorTable<Dummy>::Symbols[26];
+template <class Dummy> constexpr long        RealOperatorTable<Dummy>::Priority[26];
+template <class Dummy> constexpr long        RealOperatorTable<Dummy>::ArgCount[26];
+
+//
+//  Instances of RealOperatorLib have no data; the operator symbols, priorities,
+//  argument counts and function arrays are static and shared by all instances.
+//
+class  RealOperatorLib : public SCC::OperatorLib, public RealOperatorTable<void>
 {
 
 public :
 
-	RealOperatorLib()
-	{
-	    const char* LibSymbols [] =
-	    {"+", "-", "+", "-", "*", "/","^","sin", "cos",
-	    "tan","asin","acos","atan","atan2",
-	    "sinh","cosh","tanh",
-	    "ceil","exp","abs","floor","fmod","log","log10","sqrt","pow"};
-
-	     Symbols = new const char*[operatorCount];
-	     for(long i = 0; i <  operatorCount; ++i)
-	     {
-	    	 Symbols[i] = LibSymbols[i];
-	     }
-
-	     long PriorityValues [] =
-	     {3,3,5,5,4,4,2,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1};
-
-         Priority = new long[operatorCount];
-	     for(long i = 0; i <  operatorCount; ++i)
-	     {
-	    	 Priority[i] = PriorityValues [i];
-	     }
-
-	     long ArgCountValues[] =
-	     {1,1,2,2,2,2,2,1,1,1,1,1,1,2,1,1,1,1,1,1,1,2,1,1,1,2};
-	     ArgCount = new long[operatorCount];
-
-	     for(long i = 0; i <  operatorCount; ++i)
-	     {
-	    	 ArgCount[i] = ArgCountValues[i];
-	     }
-
-
-	     void* FunctionArrayValues [] =
-	     {
-	     (void*)SCC::RealOperatorLib::Plus,
-	     (void*)SCC::RealOperatorLib::Minus,
-	     (void*)SCC::RealOperatorLib::Add,
-	     (void*)SCC::RealOperatorLib::Subtract,
-	     (void*)SCC::RealOperatorLib::Times,          // 5 //
-	     (void*)SCC::RealOperatorLib::Divide,
-	     (void*)SCC::RealOperatorLib::Exponentiate,
-	     (void*)SCC::RealOperatorLib::Sin,
-	     (void*)SCC::RealOperatorLib::Cos,
-	     (void*)SCC::RealOperatorLib::Tan,            // 10 //
-	     (void*)SCC::RealOperatorLib::Asin,
-	     (void*)SCC::RealOperatorLib::Acos,
-	     (void*)SCC::RealOperatorLib::Atan,
-	     (void*)SCC::RealOperatorLib::Atan2,           //14//
-	     (void*)SCC::RealOperatorLib::Sinh,
-	     (void*)SCC::RealOperatorLib::Cosh,
-	     (void*)SCC::RealOperatorLib::Tanh,
-	     (void*)SCC::RealOperatorLib::Ceil,
-	     (void*)SCC::RealOperatorLib::Exp,
-	     (void*)SCC::RealOperatorLib::Abs,           // 20 //
-	     (void*)SCC::RealOperatorLib::Floor,
-	     (void*)SCC::RealOperatorLib::Fmod,
-	     (void*)SCC::RealOperatorLib::Log,
-	     (void*)SCC::RealOperatorLib::Log10,           // 24 //
-	     (void*)SCC::RealOperatorLib::Sqrt,            // 25 //
-	     (void*)SCC::RealOperatorLib::Pow
-	     };
-
-	     FunctionArray = new void*[operatorCount];
-	     for(long i = 0; i <  operatorCount; ++i)
-	     {
-	    	 FunctionArray[i] = FunctionArrayValues[i];
-	     }
-	}
-
-	~RealOperatorLib()
-	{
-		delete [] Symbols;
-		delete [] Priority;
-		delete [] ArgCount;
-		delete [] FunctionArray;
-	}
+//
+//  Returns the array of scalar operators
+//
+    static void* const* getFunctionArray()
+    {
+        static void* const functionArray[operatorCount] =
+        {
+        (void*)SCC::RealOperatorLib::Plus,
+        (void*)SCC::RealOperatorLib::Minus,
+        (void*)SCC::RealOperatorLib::Add,
+        (void*)SCC::RealOperatorLib::Subtract,
+        (void*)SCC::RealOperatorLib::Times,   // 5 //
+        (void*)SCC::RealOperatorLib::Divide,
+        (void*)SCC::RealOperatorLib::Exponentiate,
+        (void*)SCC::RealOperatorLib::Sin,
+        (void*)SCC::RealOperatorLib::Cos,
+        (void*)SCC::RealOperatorLib::Tan,   // 10 //
+        (void*)SCC::RealOperatorLib::Asin,
+        (void*)SCC::RealOperatorLib::Acos,
+        (void*)SCC::RealOperatorLib::Atan,
+        (void*)SCC::RealOperatorLib::Atan2,   // 14 //
+        (void*)SCC::RealOperatorLib::Sinh,
+        (void*)SCC::RealOperatorLib::Cosh,
+        (void*)SCC::RealOperatorLib::Tanh,
+        (void*)SCC::RealOperatorLib::Ceil,
+        (void*)SCC::RealOperatorLib::Exp,
+        (void*)SCC::RealOperatorLib::Abs,   // 20 //
+        (void*)SCC::RealOperatorLib::Floor,
+        (void*)SCC::RealOperatorLib::Fmod,
+        (void*)SCC::RealOperatorLib::Log,
+        (void*)SCC::RealOperatorLib::Log10,   // 24 //
+        (void*)SCC::RealOperatorLib::Sqrt,   // 25 //
+        (void*)SCC::RealOperatorLib::Pow
+        };
+        return functionArray;
+    }
+
+//
+//  Returns the arrays of block operators. The arrays are created on first
+//  use, at which time the vectorized operators for the CPU are selected.
+//
+    static void* const* getBlockFunctionArray()
+    {
+        static const BlockFunctionTable<double> blockFunctionTable;
+        return blockFunctionTable.functionArray;
+    }
 
+    static void* const* getFloatBlockFunctionArray()
+    {
+        static const BlockFunctionTable<float> blockFunctionTable;
+        return blockFunctionTable.functionArray;
+    }
 
     long getOperatorIndex(const char* Sym) const
     {
@@ -165,6 +182,101 @@ public :
     {
      	return Symbols[index];
     }
+//
+//  Instruction set levels of the vectorized block operators
+//
+    enum {ISA_GENERIC = 0, ISA_SSE2 = 1, ISA_AVX2 = 2, ISA_AVX512 = 3};
+
+//
+//  Returns the instruction set level used by the block operators. The level is
+//  determined once, on first use, from the features of the CPU. A lower level
+//  can be specified with the environment variable SCC_SYMFUN_ISA
+//  (= generic, sse2, avx2 or avx512); a level above that supported
+//  by the CPU is ignored.
+//
+    static long getInstructionSetLevel()
+    {
+        static const long instructionSetLevel = selectInstructionSetLevel();
+        return instructionSetLevel;
+    }
+
+    static long selectInstructionSetLevel()
+    {
+        long level = detectInstructionSetLevel();
+
+        const char* isaName = std::getenv("SCC_SYMFUN_ISA");
+        if(isaName != 0)
+        {
+        long requestedLevel = level;
+        if(strcmp(isaName,"generic") == 0) requestedLevel = ISA_GENERIC;
+        if(strcmp(isaName,"sse2")    == 0) requestedLevel = ISA_SSE2;
+        if(strcmp(isaName,"avx2")    == 0) requestedLevel = ISA_AVX2;
+        if(strcmp(isaName,"avx512")  == 0) requestedLevel = ISA_AVX512;
+        if(requestedLevel < level) level = requestedLevel;
+        }
+        return level;
+    }
+
+//
+//  Determines the instruction set level supported by the CPU with cpuid. The AVX
+//  levels also require that the operating system saves the corresponding
+//  register state (checked with xgetbv).
+//
+    static long detectInstructionSetLevel()
+    {
+#ifdef SCC_X86_KERNELS_
+        unsigned int ecx1 = 0;    // cpuid leaf 1 feature flags
+        unsigned int edx1 = 0;
+        unsigned int ebx7 = 0;    // cpuid leaf 7 extended feature flags
+
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info,0);
+        unsigned int maxLeaf = (unsigned int)info[0];
+        if(maxLeaf >= 1) {__cpuid(info,1);        ecx1 = (unsigned int)info[2]; edx1 = (unsigned int)info[3];}
+        if(maxLeaf >= 7) {__cpuidex(info,7,0);    ebx7 = (unsigned int)info[1];}
+#else
+        unsigned int eax; unsigned int ebx; unsigned int ecx; unsigned int edx;
+        unsigned int maxLeaf = __get_cpuid_max(0,0);
+        if(maxLeaf >= 1) {__cpuid(1,eax,ebx,ecx1,edx1);}
+        if(maxLeaf >= 7) {__cpuid_count(7,0,eax,ebx7,ecx,edx);}
+#endif
+
+        long level = ISA_GENERIC;
+        if(edx1 & (1u << 26)) level = ISA_SSE2;
+
+        bool osxsave = (ecx1 & (1u << 27)) != 0;
+        if(!osxsave) return level;
+
+        unsigned long long xcr0 = getXCR0();
+        bool avxState    = ((xcr0 & 0x6)  == 0x6);
+        bool avx512State = ((xcr0 & 0xE6) == 0xE6);
+
+        bool avx     = (ecx1 & (1u << 28)) != 0;
+        bool avx2    = (ebx7 & (1u << 5))  != 0;
+        bool avx512f = (ebx7 & (1u << 16)) != 0;
+
+        if(avxState && avx && avx2) level = ISA_AVX2;
+        if((level == ISA_AVX2) && avx512State && avx512f) level = ISA_AVX512;
+        return level;
+#else
+        return ISA_GENERIC;
+#endif
+    }
+
+#ifdef SCC_X86_KERNELS_
+#if defined(_MSC_VER)
+    static unsigned long long getXCR0() {return (unsigned long long)_xgetbv(0);}
+#else
+    static unsigned long long getXCR0()
+    {
+        unsigned int eax; unsigned int edx;
+        __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return ((unsigned long long)edx << 32) | eax;
+    }
+#endif
+#endif
+
 //
 //  Unary Operators
 //
@@ -248,12 +360,175 @@ public :
 
 
 
-    constexpr static long  operatorCount = 26;
+//
+//  Block operators : each argument pointer references an array of n values
+//  and the operation is applied elementwise. These are used by the block
+//  interpreter of SCC::SymFun, where the cost of the operator dispatch is
+//  amortized over the block and the loops are candidates for vectorization.
+//  The operators are instantiated for T = double and T = float.
+//
+    template<class T>
+    static void BlockPlus(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  +argPtr[0][k];} }
+
+    template<class T>
+    static void BlockMinus(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  -argPtr[0][k];} }
+
+    template<class T>
+    static void BlockAdd(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[2][k] =  argPtr[0][k] + argPtr[1][k];} }
+
+    template<class T>
+    static void BlockSubtract(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[2][k] =  argPtr[0][k] - argPtr[1][k];} }
+
+    template<class T>
+    static void BlockTimes(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[2][k] =  argPtr[0][k] * argPtr[1][k];} }
+
+    template<class T>
+    static void BlockDivide(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[2][k] =  argPtr[0][k] / argPtr[1][k];} }
+
+    template<class T>
+    static void BlockExponentiate(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[2][k] =  std::pow(argPtr[0][k],argPtr[1][k]);} }
+
+    template<class T>
+    static void BlockSin(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::sin(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockCos(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::cos(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockTan(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::tan(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockAsin(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::asin(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockAcos(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::acos(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockAtan(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::atan(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockAtan2(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[2][k] =  std::atan2(argPtr[0][k],argPtr[1][k]);} }
+
+    template<class T>
+    static void BlockSinh(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::sinh(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockCosh(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::cosh(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockTanh(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::tanh(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockCeil(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::ceil(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockExp(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::exp(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockAbs(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::abs(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockFloor(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::floor(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockFmod(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[2][k] =  std::fmod(argPtr[0][k],argPtr[1][k]);} }
+
+    template<class T>
+    static void BlockLog(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::log(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockLog10(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::log10(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockSqrt(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[1][k] =  std::sqrt(argPtr[0][k]);} }
+
+    template<class T>
+    static void BlockPow(T** const argPtr, long n)
+    {   for(long k = 0; k < n; ++k) {argPtr[2][k] =  std::pow(argPtr[0][k],argPtr[1][k]);} }
+
+
+private :
+
+    template <class T>
+    class BlockFunctionTable
+    {
+    public :
+
+        BlockFunctionTable()
+        {
+            void* functionArrayValues [] =
+            {
+            (void*)SCC::RealOperatorLib::BlockPlus<T>,
+            (void*)SCC::RealOperatorLib::BlockMinus<T>,
+            (void*)SCC::RealOperatorLib::BlockAdd<T>,
+            (void*)SCC::RealOperatorLib::BlockSubtract<T>,
+            (void*)SCC::RealOperatorLib::BlockTimes<T>,   // 5 //
+            (void*)SCC::RealOperatorLib::BlockDivide<T>,
+            (void*)SCC::RealOperatorLib::BlockExponentiate<T>,
+            (void*)SCC::RealOperatorLib::BlockSin<T>,
+            (void*)SCC::RealOperatorLib::BlockCos<T>,
+            (void*)SCC::RealOperatorLib::BlockTan<T>,   // 10 //
+            (void*)SCC::RealOperatorLib::BlockAsin<T>,
+            (void*)SCC::RealOperatorLib::BlockAcos<T>,
+            (void*)SCC::RealOperatorLib::BlockAtan<T>,
+            (void*)SCC::RealOperatorLib::BlockAtan2<T>,   // 14 //
+            (void*)SCC::RealOperatorLib::BlockSinh<T>,
+            (void*)SCC::RealOperatorLib::BlockCosh<T>,
+            (void*)SCC::RealOperatorLib::BlockTanh<T>,
+            (void*)SCC::RealOperatorLib::BlockCeil<T>,
+            (void*)SCC::RealOperatorLib::BlockExp<T>,
+            (void*)SCC::RealOperatorLib::BlockAbs<T>,   // 20 //
+            (void*)SCC::RealOperatorLib::BlockFloor<T>,
+            (void*)SCC::RealOperatorLib::BlockFmod<T>,
+            (void*)SCC::RealOperatorLib::BlockLog<T>,
+            (void*)SCC::RealOperatorLib::BlockLog10<T>,   // 24 //
+            (void*)SCC::RealOperatorLib::BlockSqrt<T>,   // 25 //
+            (void*)SCC::RealOperatorLib::BlockPow<T>
+            };
+
+            for(long i = 0; i <  operatorCount; ++i)
+            {
+                functionArray[i] = functionArrayValues[i];
+            }
+
+            // Dispatch to the vectorized block operators for the CPU
+
+            setBlockKernels(functionArray,(T*)0);
+        }
+
+        void* functionArray[operatorCount];
+    };
+
+    static void setBlockKernels(void** blockFunctionArray, double*)
+    {SCC::RealBlockKernels::setBlockFunctions(blockFunctionArray,getInstructionSetLevel());}
 
-    void**   FunctionArray;
-    const char**   Symbols;
-    long*         Priority;
-    long*         ArgCount;
+    static void setBlockKernels(void** blockFunctionArray, float*)
+    {SCC::RealBlockKernels::setFloatBlockFunctions(blockFunctionArray,getInstructionSetLevel());}
 };
 }
 #endif
@@ -44,6 +44,12 @@
 #include <cstdlib>
 #include <cstdio>
 #include <map>
+#include <thread>
+#include <algorithm>
+#include <utility>
+#include <memory>
+#include <cstdint>
+#include <sstream>
 
 #ifndef SYMBOLIC_FUNCTION_
 #define SYMBOLIC_FUNCTION_
@@ -53,7 +59,14 @@
 #include "SCC_OperatorLib.h"
 #include "SCC_RealOperatorLib.h"
 #include "SCC_ExpressionTransform.h"
+#include "SCC_SymFunProgram.h"
+#include "SCC_SymFunProgramBuilder.h"
+#include "SCC_SymFunSymbolTable.h"
+#include "SCC_SymFunMemoryResource.h"
 #include "SCC_SymFunException.h"
+#include "SCC_SymFunEvaluationPlan.h"
+#include "SCC_SymFunOutputMode.h"
+#include "SCC_SymFunReduction.h"
 
 //
 // strcpy_s is not implemented as part of C++11 (arrgh) so this macro
@@ -66,6 +79,19 @@
 #define COPYSTR(dst,count,src) strcpy(dst,src)
 #endif
 
+//
+// Prefetch hint used when gathering strided batch input
+//
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SCC_SYMFUN_PREFETCH(p) __builtin_prefetch(p)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define SCC_SYMFUN_PREFETCH(p) _mm_prefetch((const char*)(p),_MM_HINT_T0)
+#else
+#define SCC_SYMFUN_PREFETCH(p)
+#endif
+
 namespace SCC
 {
 
@@ -115,80 +141,28 @@ public  :
     }
 
     /**
-       Copy constructor. Creates a duplicate of F
+       Copy constructor. Creates a duplicate of F. The compiled program and symbol tables
+       are shared with F; the values of the symbolic constants are copied only when they
+       are changed with setConstantValue(...).
      */
      SymFun(const SymFun& F)
      {
          bool nullInstanceFlag = true;
          destroy(nullInstanceFlag);
-     //
-     //  Allocate Storage and Initalize
-     //
-         long i;
-
-         if(F.constructorString != 0)
-         {
-         constructorString = new char[strlen(F.constructorString) + 1];
-         COPYSTR(constructorString, strlen(F.constructorString) + 1,F.constructorString);
-         }
-
-         if(F.variableCount != 0)
-         {
-         variableNames  = new char*[F.variableCount];
-         variableCount  = F.variableCount;
-
-         for(i = 0; i < F.variableCount; i++)
-         {
-         variableNames[i] = new char[strlen(F.variableNames[i]) + 1];
-         COPYSTR(variableNames[i], strlen(F.variableNames[i]) + 1,F.variableNames[i]);
-         }
-         }
-
-         if(F.constantCount != 0)
-         {
-         constantNames  = new char*[F.constantCount];
-         constantCount  = F.constantCount;
-         constantValues = new double[F.constantCount];
-
-         for(i = 0; i < F.constantCount; i++)
-         {
-         constantNames[i] = new char[strlen(F.constantNames[i]) + 1];
-         COPYSTR(constantNames[i], strlen(F.constantNames[i]) + 1,F.constantNames[i]);
-         constantValues[i] = F.constantValues[i];
-         }
-         }
-
-         evaluationDataSize = F.evaluationDataSize;
-
-         if(F.evaluationData != 0)
-         {
-         evaluationData     = new double[evaluationDataSize];
-         for(i=0; i< evaluationDataSize; i++)
-         {
-         evaluationData[i] = F.evaluationData[i];
-         }}
-
-         executionArraySize = F.executionArraySize;
-
-         if(F.executionArray != 0)
-         {
-         executionArray     = new long[executionArraySize];
-         for(i=0; i< executionArraySize; i++)
-         {
-         executionArray[i] = F.executionArray[i];
-         }}
-
-         symbolCount = F.symbolCount;
-         sNames      = new char*[symbolCount];
-         for(i=0; i< symbolCount; i++)
-         {
-         sNames[i] = new char[strlen(F.sNames[i])+1];
-         COPYSTR(sNames[i], strlen(F.sNames[i]) + 1,F.sNames[i]);
-         }
-
-         LibFunctions       = RealOpLib.FunctionArray;
+         memoryResource = F.memoryResource;
+         initialize(F);
      }
 
+    /**
+       Move constructor. Transfers the data of F to the instance being created;
+       F is left as a null instance.
+     */
+     SymFun(SymFun&& F) noexcept
+     {
+         bool nullInstanceFlag = true;
+         destroy(nullInstanceFlag);
+         swap(F);
+     }
 
     /**
     Creates a SCC::SymFun instance to be a function in one variable, x, where the function is
@@ -295,6 +269,23 @@ public  :
         initialize(V,C,Cvalues,S);
     }
 
+    /**
+    Creates a SymFun instance as SymFun(V,C,Cvalues,S), with the program and evaluation data of the
+    instance allocated from the memory resource specified by resource (e.g. an SCC::SymFunArena
+    or, with C++17, any std::pmr::memory_resource wrapped in an SCC::SymFunPMRadapter). The memory
+    resource must remain valid until the instance, and all copies of it, are destroyed.
+    */
+
+    SymFun(const std::vector<std::string>& V, const std::vector<std::string>& C, const std::vector<double>& Cvalues, const std::string& S,
+           SymFunMemoryResource* resource)
+    {
+        bool nullInstanceFlag = true;
+        destroy(nullInstanceFlag);
+
+        memoryResource = resource;
+        initialize(V,C,Cvalues,S);
+    }
+
     /**
       Initializes a SCC::SymFun instance to a null instance.
     */
@@ -310,72 +301,22 @@ public  :
 
     long initialize(const SymFun& F)
     {
+        if(this == &F) return 0;
         destroy();
     //
-    //  Allocate Storage and Initalize
+    //  Share the compiled program. The evaluation data is allocated when the
+    //  instance is first evaluated, or here if the values of the symbolic
+    //  constants of F differ from those of the program.
     //
-        long i;
-        if(F.constructorString != 0)
-        {
-        constructorString = new char[strlen(F.constructorString) + 1];
-        COPYSTR(constructorString, strlen(F.constructorString) + 1,F.constructorString);
-        }
-
-        if(F.variableCount != 0)
-        {
-        variableNames  = new char*[F.variableCount];
-        variableCount  = F.variableCount;
-
-        for(i = 0; i < F.variableCount; i++)
-        {
-        variableNames[i] = new char[strlen(F.variableNames[i]) + 1];
-        COPYSTR(variableNames[i], strlen(F.variableNames[i]) + 1,F.variableNames[i]);
-        }
-        }
-
-        if(F.constantCount != 0)
-        {
-        constantNames  = new char*[F.constantCount];
-        constantCount  = F.constantCount;
-        constantValues = new double[F.constantCount];
-
-        for(i = 0; i < F.constantCount; i++)
-        {
-        constantNames[i] = new char[strlen(F.constantNames[i]) + 1];
-        COPYSTR(constantNames[i], strlen(F.constantNames[i]) + 1,F.constantNames[i]);
-        constantValues[i] = F.constantValues[i];
-        }
-        }
-
-        evaluationDataSize = F.evaluationDataSize;
-
-        if(F.evaluationData != 0)
-        {
-        evaluationData     = new double[evaluationDataSize];
-        for(i=0; i< evaluationDataSize; i++)
-        {
-        evaluationData[i] = F.evaluationData[i];
-        }}
-
-        executionArraySize = F.executionArraySize;
-
-        if(F.executionArray != 0)
-        {
-        executionArray     = new long[executionArraySize];
-        for(i=0; i< executionArraySize; i++)
-        {
-        executionArray[i] = F.executionArray[i];
-        }}
+        program        = F.program;
+        setProgramData();
+        constantValues = program ? program->constantValues : 0;
 
-        symbolCount = F.symbolCount;
-        sNames      = new char*[symbolCount];
-        for(i=0; i< symbolCount; i++)
+        if(F.constantsModified())
         {
-        sNames[i] = new char[strlen(F.sNames[i])+1];
-        COPYSTR(sNames[i], strlen(F.sNames[i]) + 1,F.sNames[i]);
+        setInstanceConstants();
+        for(long i = 0; i < constantCount; i++) {constantValues[i] = F.constantValues[i];}
         }
-
-        LibFunctions       = RealOpLib.FunctionArray;
         return 0;
     }
 
@@ -546,6 +487,24 @@ public  :
 
 
 
+    /**
+      Sets the memory resource from which the data of the instance is allocated
+      (0 = new/delete). The instance is set to a null instance; the instance
+      and copies made from it allocate from resource once initialized. The memory
+      resource must remain valid until the instance, and all copies of it, are destroyed.
+    */
+
+    void setMemoryResource(SymFunMemoryResource* resource)
+    {
+        destroy();
+        memoryResource = resource;
+    }
+
+    SymFunMemoryResource* getMemoryResource() const
+    {
+        return memoryResource;
+    }
+
     //
     //##################################################################
     //                     OPERATORS
@@ -556,11 +515,118 @@ public  :
         data associated with the original instance is destroyed.
     */
 
-    void operator=(const SymFun& F)
+    SymFun& operator=(const SymFun& F)
+    {
+        if(this != &F) initialize(F);
+        return *this;
+    }
+
+    /** Move assignment operator. The data associated with the original instance is
+        destroyed and the data of F is transferred to the instance; F is left as a null instance.
+    */
+
+    SymFun& operator=(SymFun&& F) noexcept
+    {
+        if(this != &F)
+        {
+            destroy();
+            swap(F);
+        }
+        return *this;
+    }
+
+    /**
+     Exchanges the data of the instance with that of F. No data is copied
+     and no memory is allocated.
+    */
+
+    void swap(SymFun& F) noexcept
+    {
+        std::swap(program,        F.program);
+        std::swap(evaluationData, F.evaluationData);
+        std::swap(constantValues, F.constantValues);
+        std::swap(memoryResource, F.memoryResource);
+
+        // Reset the data cached from the program
+
+        setProgramData();
+        F.setProgramData();
+    }
+
+    friend void swap(SymFun& A, SymFun& B) noexcept
+    {
+        A.swap(B);
+    }
+
+    /**
+     Algebraic operators. The result of A op B, where A and B are SCC::SymFun instances or
+     doubles, is an SCC::SymFun whose program is created by combining the compiled programs of A
+     and B; no expression is parsed. The variables of the result are those of A followed by
+     any additional variables of B, and symbolic constants with the same name are the same
+     constant, with the value of the constant of A. Operations common to A and B are carried
+     out once.
+
+     A name that is a variable of A and a symbolic constant of B, or a symbolic constant of A and
+     a variable of B, generates an SCC::SymFunException before the result is created (for compound
+     assignments the instance is then unchanged), since the result would otherwise have a variable
+     and a symbolic constant with the same name.
+
+     The constructor string of the result, e.g. (x^2)+(sin(x)), specifies the function.
+
+     Sample construction of an objective function from weighted terms:
+     \code
+     std::vector<std::string> V = {"x","y"};
+     SCC::SymFun E(V,"0");
+
+     for(long k = 0; k < termCount; k++)
+     {
+     E += w[k]*SCC::SymFun(V,terms[k]);
+     }
+     \endcode
+    */
+
+    friend SymFun operator+(const SymFun& A, const SymFun& B) {return combine(A,B,"+");}
+    friend SymFun operator-(const SymFun& A, const SymFun& B) {return combine(A,B,"-");}
+    friend SymFun operator*(const SymFun& A, const SymFun& B) {return combine(A,B,"*");}
+    friend SymFun operator/(const SymFun& A, const SymFun& B) {return combine(A,B,"/");}
+
+    friend SymFun operator+(const SymFun& A, double b) {return combine(A,b,"+");}
+    friend SymFun operator-(const SymFun& A, double b) {return combine(A,b,"-");}
+    friend SymFun operator*(const SymFun& A, double b) {return combine(A,b,"*");}
+    friend SymFun operator/(const SymFun& A, double b) {return combine(A,b,"/");}
+
+    friend SymFun operator+(double a, const SymFun& B) {return combine(a,B,"+");}
+    friend SymFun operator-(double a, const SymFun& B) {return combine(a,B,"-");}
+    friend SymFun operator*(double a, const SymFun& B) {return combine(a,B,"*");}
+    friend SymFun operator/(double a, const SymFun& B) {return combine(a,B,"/");}
+
+    /**
+     Unary minus : returns an SCC::SymFun for -A.
+    */
+
+    friend SymFun operator-(const SymFun& A)
     {
-        initialize(F);
+        SymFunProgramBuilder B;
+        std::string S;
+        long a = addOperand(B,A,S);
+        long r = B.addOperation(RealOperatorLib().getUnaryOperatorIndex("-"),&a,1);
+
+        SymFun R;
+        std::vector<long> outputSlots;
+        R.create(B,&r,1,outputSlots,"-" + S);
+        return R;
     }
 
+    SymFun& operator+=(const SymFun& B) {*this = *this + B; return *this;}
+    SymFun& operator-=(const SymFun& B) {*this = *this - B; return *this;}
+    SymFun& operator*=(const SymFun& B) {*this = *this * B; return *this;}
+    SymFun& operator/=(const SymFun& B) {*this = *this / B; return *this;}
+
+    SymFun& operator+=(double b) {*this = *this + b; return *this;}
+    SymFun& operator-=(double b) {*this = *this - b; return *this;}
+    SymFun& operator*=(double b) {*this = *this * b; return *this;}
+    SymFun& operator/=(double b) {*this = *this / b; return *this;}
+
 
     //
     //##################################################################
@@ -579,6 +645,7 @@ public  :
     double operator()(double x) const
     {
             if(variableCount != 1) argError(1, variableCount);
+            if(evaluationData == 0) createEvaluationData();
             evaluationData[0] = x;
             return evaluate();
     }
@@ -592,6 +659,7 @@ public  :
     double operator()(double x1, double x2) const
     {
         if(variableCount != 2) argError(2, variableCount);
+        if(evaluationData == 0) createEvaluationData();
 
         evaluationData[0] = x1;
         evaluationData[1] = x2;
@@ -609,6 +677,7 @@ public  :
     double operator()(double x1, double x2, double x3) const
     {
         if(variableCount != 3) argError(3, variableCount);
+        if(evaluationData == 0) createEvaluationData();
 
         evaluationData[0] = x1;
         evaluationData[1] = x2;
@@ -626,6 +695,7 @@ public  :
     double operator()(double x1, double x2, double x3, double x4) const
     {
          if(variableCount != 4) argError(4, variableCount);
+         if(evaluationData == 0) createEvaluationData();
 
         evaluationData[0] = x1;
         evaluationData[1] = x2;
@@ -646,6 +716,7 @@ public  :
     {
         long n = (int)x.size();
         if(variableCount != n) argError(n, variableCount);
+        if(evaluationData == 0) createEvaluationData();
 
         long i;
         for(i = 0; i < n; i++) evaluationData[i] = x[i];
@@ -667,6 +738,7 @@ public  :
     double operator()(double*x, long n) const
     {
          if(variableCount != n) argError(n, variableCount);
+         if(evaluationData == 0) createEvaluationData();
 
         long i;
         for(i = 0; i < n; i++) evaluationData[i] = x[i];
@@ -674,6 +746,491 @@ public  :
     }
 
 
+    //
+    //##################################################################
+    //                 BATCH EVALUATION
+    //##################################################################
+    //
+
+    /**
+     Evaluates the SCC::SymFun at n points using the block interpreter. The values of the ith
+     variable are specified in the array x[i], i.e. x[i][k] is the value of the ith variable
+     at the kth point. The function values are returned in f[0], ... ,f[n-1].
+
+     The evaluation does not modify the instance, so distinct threads may
+     invoke evaluateBatch(...) with the same instance concurrently.
+
+     The value type T may be double or float. When T = float the numeric and symbolic
+     constants are rounded to float and all operations are carried out in single precision,
+     which doubles the number of values processed by each vector instruction.
+
+     @arg x : array of getVariableCount() pointers to arrays of n variable values
+     @arg n : the number of evaluation points
+     @arg f : array of n values for the function values
+
+     <HR>
+     Sample evaluation of a function of two variables at 1000 points.
+     \code
+     std::vector<std::string> V = {"x","y"};
+     SCC::SymFun F(V,"x^2 + 2*y");
+
+     std::vector<double> x(1000), y(1000), f(1000);
+     ...
+     const double* X[] = {&x[0],&y[0]};
+     F.evaluateBatch(X,1000,&f[0]);
+     \endcode
+    */
+
+    template<class T>
+    void evaluateBatch(const T* const* x, long n, T* f) const
+    {
+        evaluateBatch(x,n,f,SymFunEvaluationPlan());
+    }
+
+    /**
+     Evaluates the SCC::SymFun at n points using the backend, block size and thread count
+     specified by plan. See evaluateBatch(x,n,f) for a description of the arguments and
+     SCC::SymFunEvaluationPlanner for the construction of plans.
+    */
+
+    template<class T>
+    void evaluateBatch(const T* const* x, long n, T* f, const SymFunEvaluationPlan& plan) const
+    {
+        if((n <= 0)||(executionArraySize == 0)) return;
+
+        std::vector<double> data(evaluationDataSize);
+        initializeEvaluationData(&data[0]);
+
+        evaluatePlan(BatchArrays<T>(x,variableCount,f),&data[0],1,n,plan);
+    }
+
+    /**
+     Evaluates the SCC::SymFun at n points and combines the function values with the values
+     in f as specified by output, e.g. f[k] += alpha*F(x_k) for output = SymFunOutputMode(SymFunOutputMode::SCALED_ADD,alpha).
+     The combination is carried out as each block of values is stored. See evaluateBatch(x,n,f) for a
+     description of the other arguments.
+
+     Sample:
+     \code
+     // y[k] += 0.5*F(x[k],t[k])
+
+     const double* X[] = {&x[0],&t[0]};
+     F.evaluateBatch(X,n,&y[0],SCC::SymFunOutputMode(SCC::SymFunOutputMode::SCALED_ADD,0.5));
+     \endcode
+    */
+
+    template<class T>
+    void evaluateBatch(const T* const* x, long n, T* f, const SymFunOutputMode& output,
+                       const SymFunEvaluationPlan& plan = SymFunEvaluationPlan()) const
+    {
+        if((n <= 0)||(executionArraySize == 0)) return;
+
+        std::vector<double> data(evaluationDataSize);
+        initializeEvaluationData(&data[0]);
+
+        BatchArrays<T> A(x,variableCount,f);
+        A.outputOperation = output.operation;
+        A.outputScale     = output.alpha;
+
+        evaluatePlan(A,&data[0],1,n,plan);
+    }
+
+    /**
+     Evaluates the SCC::SymFun at n points and returns the sum, sum of squares, minimum and maximum
+     (and the indices of the minimum and maximum) of the function values; see SCC::SymFunReduction.
+     The values are reduced as each block is evaluated, so no array of n function values is created.
+
+     With the THREADED backend each thread reduces a contiguous range of blocks and the
+     results of the threads are combined. Since floating point addition is not associative,
+     sums then depend on the thread count. If deterministic is true the sums are formed from
+     the sums over each block, combined in block order, so the result depends only on the
+     block size of the plan and not on the thread count.
+
+     The block interpreter is used for all backends (the SCALAR backend is treated as BLOCK).
+
+     @arg x             : array of getVariableCount() pointers to arrays of n variable values
+     @arg n             : the number of evaluation points
+     @arg deterministic : if true, results are independent of the thread count
+
+     <HR>
+     Sample midpoint rule quadrature.
+     \code
+     SCC::SymFun F({"x"},"exp(-x^2)");
+
+     std::vector<double> x(n);
+     for(long k = 0; k < n; k++) {x[k] = a + (k + 0.5)*h;}
+
+     const double* X[] = {&x[0]};
+     double integral = h*F.evaluateReduction(X,n).sum;
+     \endcode
+    */
+
+    template<class T>
+    SymFunReduction evaluateReduction(const T* const* x, long n, bool deterministic = false) const
+    {
+        return evaluateReduction(x,n,deterministic,SymFunEvaluationPlan());
+    }
+
+    /**
+     Evaluates the reductions of the function values at n points using the block size and thread count
+     specified by plan. See evaluateReduction(x,n,deterministic) for a description of the arguments.
+    */
+
+    template<class T>
+    SymFunReduction evaluateReduction(const T* const* x, long n, bool deterministic,
+                                      const SymFunEvaluationPlan& plan) const
+    {
+        SymFunReduction R;
+        if((n <= 0)||(executionArraySize == 0)) return R;
+
+        std::vector<double> data(evaluationDataSize);
+        initializeEvaluationData(&data[0]);
+
+        long blockSize   = (plan.blockSize > 0) ? plan.blockSize : 1;
+        long blockCount  = (n + blockSize - 1)/blockSize;
+        long threadCount = (plan.backend == SymFunEvaluationPlan::THREADED) ? plan.threadCount : 1;
+        if(threadCount > blockCount) threadCount = blockCount;
+        if(threadCount < 1)          threadCount = 1;
+
+        // A reduction for each thread, or for each block
+
+        std::vector<SymFunReduction> partial(deterministic ? blockCount : threadCount);
+        std::vector< BatchArrays<T> > threadArrays(threadCount,BatchArrays<T>(x,variableCount,(T*)0));
+
+        long chunkSize = ((blockCount + threadCount - 1)/threadCount)*blockSize;
+
+        std::vector<std::thread> threads;
+        for(long t = 0; t < threadCount; t++)
+        {
+            long kBegin = t*chunkSize;
+            long kEnd   = (kBegin + chunkSize < n) ? kBegin + chunkSize : n;
+
+            threadArrays[t].reduction         = deterministic ? &partial[0] : &partial[t];
+            threadArrays[t].reductionPerBlock = deterministic;
+
+            if(t == 0) continue;
+            if(kBegin >= n) break;
+            threads.push_back(std::thread(&SymFun::evaluateBlocks<T>,this,std::cref(threadArrays[t]),
+                              &data[0],1,n,kBegin,kEnd,blockSize));
+        }
+
+        evaluateBlocks(threadArrays[0],&data[0],1,n,0,(chunkSize < n) ? chunkSize : n,blockSize);
+
+        for(size_t t = 0; t < threads.size(); t++) {threads[t].join();}
+
+        for(size_t i = 0; i < partial.size(); i++) {R.combine(partial[i]);}
+        return R;
+    }
+
+    /**
+     Evaluates the SCC::SymFun at n points for each of setCount sets of values of the
+     symbolic constants (a parameter sweep). The values of the jth symbolic constant are
+     specified in the array c[j], i.e. c[j][s] is the value of the jth constant in the sth
+     set. The function values for the sth set are returned in f[s*n], ... ,f[s*n + n-1].
+
+     The constant values of the instance are neither used nor modified, so distinct
+     threads may invoke evaluateSweep(...) with the same instance concurrently.
+
+     @arg x        : array of getVariableCount() pointers to arrays of n variable values
+     @arg n        : the number of evaluation points
+     @arg c        : array of getConstantCount() pointers to arrays of setCount constant values
+     @arg setCount : the number of sets of constant values
+     @arg f        : array of setCount*n values for the function values
+
+     <HR>
+     Sample evaluation of a*x + b at 1000 points for 100 values of a and b.
+     \code
+     SCC::SymFun F({"x"},{"a","b"},{1.0,0.0},"a*x + b");
+
+     std::vector<double> x(1000), a(100), b(100), f(100*1000);
+     ...
+     const double* X[] = {&x[0]};
+     const double* C[] = {&a[0],&b[0]};
+     F.evaluateSweep(X,1000,C,100,&f[0]);
+     \endcode
+    */
+
+    template<class T>
+    void evaluateSweep(const T* const* x, long n, const double* const* c, long setCount, T* f) const
+    {
+        evaluateSweep(x,n,c,setCount,f,SymFunEvaluationPlan());
+    }
+
+    /**
+     Evaluates a parameter sweep using the backend, block size and thread count specified by
+     plan. See evaluateSweep(x,n,c,setCount,f) for a description of the arguments. With the
+     THREADED backend the constant sets are divided among the threads when there are
+     at least as many sets as threads, otherwise the points are divided among the threads.
+    */
+
+    template<class T>
+    void evaluateSweep(const T* const* x, long n, const double* const* c, long setCount, T* f,
+                       const SymFunEvaluationPlan& plan) const
+    {
+        if((n <= 0)||(setCount <= 0)||(executionArraySize == 0)) return;
+
+        // An evaluation data array for each set of constant values
+
+        std::vector<double> data(setCount*evaluationDataSize);
+
+        for(long s = 0; s < setCount; s++)
+        {
+            double* sData = &data[s*evaluationDataSize];
+            initializeEvaluationData(sData);
+            for(long j = 0; j < constantCount; j++) {sData[variableCount + j] = c[j][s];}
+        }
+
+        evaluatePlan(BatchArrays<T>(x,variableCount,f),&data[0],setCount,n,plan);
+    }
+
+    /**
+     Evaluates the SCC::SymFun at n points where the values of the symbolic constants are
+     specified for each point (a zipped parameter sweep): x[i][k] is the value of the ith variable
+     and c[j][k] is the value of the jth symbolic constant at the kth point. The function values
+     are returned in f[0], ... ,f[n-1].
+
+     The constant values of the instance are neither used nor modified.
+
+     @arg x : array of getVariableCount() pointers to arrays of n variable values
+     @arg c : array of getConstantCount() pointers to arrays of n constant values
+     @arg n : the number of evaluation points
+     @arg f : array of n values for the function values
+    */
+
+    template<class T>
+    void evaluateZipped(const T* const* x, const T* const* c, long n, T* f) const
+    {
+        evaluateZipped(x,c,n,f,SymFunEvaluationPlan());
+    }
+
+    /**
+     Evaluates a zipped parameter sweep using the backend, block size and thread count specified by
+     plan. See evaluateZipped(x,c,n,f) for a description of the arguments.
+    */
+
+    template<class T>
+    void evaluateZipped(const T* const* x, const T* const* c, long n, T* f, const SymFunEvaluationPlan& plan) const
+    {
+        if((n <= 0)||(executionArraySize == 0)) return;
+
+        // The constants are inputs that follow the variables
+
+        std::vector<const T*> inputs(variableCount + constantCount + 1);
+        for(long i = 0; i < variableCount; i++) {inputs[i] = x[i];}
+        for(long j = 0; j < constantCount; j++) {inputs[variableCount + j] = c[j];}
+
+        std::vector<double> data(evaluationDataSize);
+        initializeEvaluationData(&data[0]);
+
+        evaluatePlan(BatchArrays<T>(&inputs[0],variableCount + constantCount,f),&data[0],1,n,plan);
+    }
+
+    /**
+     Evaluates the SCC::SymFun at n points whose variable values are stored with arbitrary
+     strides, e.g. as fields of an array of structs or as a column of a row major matrix.
+     x[i] is the address of the value of the ith variable at the first point, and the value
+     at the kth point is at the address (char*)x[i] + k*byteStrides[i]. The function values
+     are returned in f[0], ... ,f[n-1].
+
+     The input is not copied: values of variables with strides other than sizeof(T) are
+     gathered, one block at a time, within the block interpreter.
+
+     @arg x           : array of getVariableCount() addresses of the first variable values
+     @arg byteStrides : array of getVariableCount() strides in bytes
+     @arg n           : the number of evaluation points
+     @arg f           : array of n values for the function values
+
+     <HR>
+     Sample evaluation with an array of structs.
+     \code
+     struct Particle {double x; double y; double z; double vx; double vy; double vz;};
+     std::vector<Particle> p(1000);
+     std::vector<double>   f(1000);
+     ...
+     SCC::SymFun F({"vx","vy","vz"},"0.5*(vx^2 + vy^2 + vz^2)");
+
+     const double* X[] = {&p[0].vx, &p[0].vy, &p[0].vz};
+     long strides[]    = {sizeof(Particle), sizeof(Particle), sizeof(Particle)};
+     F.evaluateStrided(X,strides,1000,&f[0]);
+     \endcode
+    */
+
+    template<class T>
+    void evaluateStrided(const T* const* x, const long* byteStrides, long n, T* f) const
+    {
+        evaluateStrided(x,byteStrides,n,f,SymFunEvaluationPlan());
+    }
+
+    /**
+     Evaluates the SCC::SymFun at n points with strided input using the backend, block size and
+     thread count specified by plan. See evaluateStrided(x,byteStrides,n,f) for a description of the arguments.
+    */
+
+    template<class T>
+    void evaluateStrided(const T* const* x, const long* byteStrides, long n, T* f, const SymFunEvaluationPlan& plan) const
+    {
+        if((n <= 0)||(executionArraySize == 0)) return;
+
+        std::vector<double> data(evaluationDataSize);
+        initializeEvaluationData(&data[0]);
+
+        BatchArrays<T> A(x,variableCount,f);
+        A.strides = byteStrides;
+
+        evaluatePlan(A,&data[0],1,n,plan);
+    }
+
+    /**
+     Evaluates the SCC::SymFun at the n points specified by an index array, e.g. the quadrature
+     nodes of a subset of the elements of a mesh. The value of the ith variable at the kth point is
+     x[i][index[k]]. If scatterAdd is false the function values are returned in f[0], ... ,f[n-1],
+     otherwise the function value at the kth point is added to f[index[k]].
+
+     The inputs are gathered, and the outputs scattered, one block at a time within the
+     block interpreter.
+
+     With the THREADED backend, scattered output is accumulated by a single thread, so
+     repeated indices are allowed.
+
+     @arg x          : array of getVariableCount() pointers to arrays of variable values
+     @arg index      : array of n indices
+     @arg n          : the number of evaluation points
+     @arg f          : array for the function values
+     @arg scatterAdd : if true, add the value at the kth point to f[index[k]]
+
+     <HR>
+     Sample evaluation of a coefficient at the nodes of a list of elements.
+     \code
+     SCC::SymFun K({"x","y"},"1 + x*y");
+
+     std::vector<double>  x(nodeCount), y(nodeCount), rhs(nodeCount,0.0);
+     std::vector<int64_t> elementNodes(n);
+     ...
+     const double* X[] = {&x[0],&y[0]};
+     K.evaluateIndexed(X,&elementNodes[0],n,&rhs[0],true);
+     \endcode
+    */
+
+    template<class T>
+    void evaluateIndexed(const T* const* x, const int64_t* index, long n, T* f, bool scatterAdd = false) const
+    {
+        evaluateIndexed(x,index,n,f,scatterAdd,SymFunEvaluationPlan());
+    }
+
+    /**
+     Evaluates the SCC::SymFun at indexed points using the backend, block size and thread count specified
+     by plan. See evaluateIndexed(x,index,n,f,scatterAdd) for a description of the arguments.
+    */
+
+    template<class T>
+    void evaluateIndexed(const T* const* x, const int64_t* index, long n, T* f, bool scatterAdd,
+                         const SymFunEvaluationPlan& plan) const
+    {
+        if((n <= 0)||(executionArraySize == 0)) return;
+
+        std::vector<double> data(evaluationDataSize);
+        initializeEvaluationData(&data[0]);
+
+        BatchArrays<T> A(x,variableCount,f);
+        A.index      = index;
+        if(scatterAdd)
+        {
+            A.scatter         = true;
+            A.outputOperation = SymFunOutputMode::ADD;
+        }
+
+        evaluatePlan(A,&data[0],1,n,plan);
+    }
+
+    /**
+     Evaluates the SCC::SymFun at n points where each variable is either a scalar, with the same
+     value at all points, or an array of n values (NumPy style broadcasting). sizes[i] is 1 if the ith
+     variable is a scalar, whose value is x[i][0], or n if it is an array, whose values are
+     x[i][0], ... ,x[i][n-1]. The function values are returned in f[0], ... ,f[n-1].
+
+     The parts of the function that depend only on scalar variables and constants are evaluated
+     once for the batch, rather than at each point.
+
+     An SCC::SymFunException is thrown if a size is neither 1 nor n.
+
+     @arg x     : array of getVariableCount() pointers to scalars or arrays of n variable values
+     @arg sizes : array of getVariableCount() sizes, each 1 or n
+     @arg n     : the number of evaluation points
+     @arg f     : array of n values for the function values
+
+     <HR>
+     Sample evaluation of f(x,y,t) for an array of x values and scalar y and t.
+     \code
+     SCC::SymFun F({"x","y","t"},"x*exp(-t) + sin(y*t)");
+
+     std::vector<double> x(1000), f(1000);
+     double y = 2.0;
+     double t = 0.5;
+     ...
+     const double* X[] = {&x[0], &y, &t};
+     long sizes[]      = {1000, 1, 1};
+     F.evaluateBroadcast(X,sizes,1000,&f[0]);
+     \endcode
+    */
+
+    template<class T>
+    void evaluateBroadcast(const T* const* x, const long* sizes, long n, T* f) const
+    {
+        evaluateBroadcast(x,sizes,n,f,SymFunEvaluationPlan());
+    }
+
+    /**
+     Evaluates the SCC::SymFun with broadcast inputs using the backend, block size and thread count specified
+     by plan. See evaluateBroadcast(x,sizes,n,f) for a description of the arguments.
+    */
+
+    template<class T>
+    void evaluateBroadcast(const T* const* x, const long* sizes, long n, T* f, const SymFunEvaluationPlan& plan) const
+    {
+        if((n <= 0)||(executionArraySize == 0)) return;
+
+        std::vector<double> data(evaluationDataSize);
+        initializeEvaluationData(&data[0]);
+
+        std::vector<char> uniform(evaluationDataSize,0);
+        for(long i = variableCount; i < symbolCount; i++) {uniform[i] = 1;}
+
+        for(long i = 0; i < variableCount; i++)
+        {
+            if(sizes[i] == 1)
+            {
+                uniform[i] = 1;
+                data[i]    = (double)x[i][0];
+            }
+            else if(sizes[i] != n)
+            {
+                std::ostringstream errInfo;
+                errInfo << "Variable " << variableNames[i] << " has size " << sizes[i]
+                        << ", expected 1 or " << n;
+                throw SymFunException("Incompatible batch sizes in evaluateBroadcast",errInfo.str(),
+                                      constructorString);
+            }
+        }
+
+        std::vector<long> program;
+        createBroadcastProgram(&data[0],uniform,program);
+
+        // The function value is the same at all points
+
+        if(uniform[evaluationDataSize - 1])
+        {
+            std::fill(f, f + n, (T)data[evaluationDataSize - 1]);
+            return;
+        }
+
+        BatchArrays<T> A(x,variableCount,f);
+        A.uniform            = &uniform[0];
+        A.executionArray     = &program[0];
+        A.executionArraySize = (long)program.size();
+
+        evaluatePlan(A,&data[0],1,n,plan);
+    }
+
     //###############################################
     //                MUTATORS
     //###############################################
@@ -748,12 +1305,9 @@ public  :
 
     double getConstantValue(const std::string& S) const
     {
-        long i;
-        for(i =0; i < constantCount; i++)
-        {
-        if(strcmp(S.c_str(),constantNames[i]) == 0) return constantValues[i];
-        }
-        return 0.0;
+        long i = getConstantIndex(S);
+        if(i < 0) return 0.0;
+        return constantValues[i];
     }
 
 
@@ -767,26 +1321,94 @@ public  :
 
     void setConstantValue(const std::string& C,double x)
     {
-           for(long i =0; i < constantCount; i++)
-           {
-           if(strcmp(C.c_str(),constantNames[i]) == 0) constantValues[i] = x;
-           }
+           long i = getConstantIndex(C);
+           if(i < 0) return;
 
-           // Reset evaluation data to reflect change in values
+           // The constant values are stored in the evaluation data
 
-           for(long i = variableCount, j = 0; i < variableCount + constantCount; ++i,++j)
-           {
-               evaluationData[i] = constantValues[j];
-           }
+           if(!constantsModified()) setInstanceConstants();
+           constantValues[i] = x;
     }
 
-
     /**
-     Sets the value of the symbolic constants
-     associated with the SCC::SymFun instance.
-
-     @arg coefficientMap: std::map<std::string,double> with keys being
-     the constant names and values the symbolic constant values.
+     A handle to a symbolic constant of an SCC::SymFun instance, obtained with
+     getConstantHandle(...). A handle holds the index of the constant, so setting
+     a constant with a handle involves no name lookup. A handle is valid for the
+     instance it was obtained from, for copies of that instance, and for any
+     instance with the same list of symbolic constants.
+    */
+
+    class ConstantHandle
+    {
+    public:
+
+        ConstantHandle() : constantIndex(-1) {}
+
+        /** Returns true if the handle refers to a symbolic constant. */
+
+        bool isValid() const {return constantIndex >= 0;}
+
+    protected:
+
+        explicit ConstantHandle(long i) : constantIndex(i) {}
+
+        long constantIndex;
+
+        friend class SymFun;
+    };
+
+    /**
+     Returns a handle to the symbolic constant named C. If there is no such
+     constant the returned handle is not valid, and setConstant(...) with
+     that handle does nothing.
+    */
+
+    ConstantHandle getConstantHandle(const std::string& C) const
+    {
+        return ConstantHandle(getConstantIndex(C));
+    }
+
+    /**
+     Sets the value of the symbolic constant specified by the handle h.
+
+     Sample:
+     \code
+        SCC::SymFun::ConstantHandle h = F.getConstantHandle("a");
+
+        for(long k = 0; k < iterationCount; k++)
+        {
+        F.setConstant(h,a[k]);
+        ...
+        }
+     \endcode
+    */
+
+    void setConstant(const ConstantHandle& h, double x)
+    {
+           if(h.constantIndex < 0) return;
+           if(!constantsModified()) setInstanceConstants();
+           constantValues[h.constantIndex] = x;
+    }
+
+    /**
+     Sets the values of all of the symbolic constants. values[i] is the value
+     of the ith constant, in the order of getConstantNames().
+    */
+
+    void setConstants(const double* values)
+    {
+           if(constantCount == 0) return;
+           if(!constantsModified()) setInstanceConstants();
+           for(long i = 0; i < constantCount; i++) {constantValues[i] = values[i];}
+    }
+
+
+    /**
+     Sets the value of the symbolic constants
+     associated with the SCC::SymFun instance.
+
+     @arg coefficientMap: std::map<std::string,double> with keys being
+     the constant names and values the symbolic constant values.
     */
 
     void setConstants(std::map<std::string,double> constantsMap)
@@ -865,6 +1487,11 @@ public  :
     //       Anonymous Function Interface
     //###############################################
 
+    //
+    // SCC::SymFunView and SCC::SymFunHandle (SCC_SymFunView.h) provide callable
+    // objects without the type erasure of std::function, and function pointer
+    // and context pairs for C style interfaces.
+    //
 
     /**
      Returns a std::function instance of a double function of a single double
@@ -974,6 +1601,12 @@ public  :
 
 
     friend class SymFunUtility;
+    friend class SymFunEvaluationPlanner;
+    friend class CompactSymFun;
+    friend class SymFunView;
+    template <long N> friend class SymFunN;
+    friend class SymFunBinding;
+    friend class SymFunSet;
 //
 //##################################################################
 //                      PROTECTED MEMBER FUNCTIONS
@@ -997,6 +1630,9 @@ protected:
 
     SymFun(char const* S)
     {
+        bool nullInstanceFlag = true;
+        destroy(nullInstanceFlag);
+
         const char* V []      = {"x"};
         long Vcount            = 1;
         const char** C        = 0;
@@ -1007,8 +1643,10 @@ protected:
     }
 
 
-    SymFun(const char** V, long Vcount, const char* S)
+    SymFun(const char* const* V, long Vcount, const char* S)
     {
+        bool nullInstanceFlag = true;
+        destroy(nullInstanceFlag);
 
         const char** C        = 0;
         long Ccount            = 0;
@@ -1016,9 +1654,11 @@ protected:
         create(V,Vcount,C,Ccount, Cvalues, S);
     }
 
-    SymFun(const char** V, long Vcount, const char** C,
+    SymFun(const char* const* V, long Vcount, const char* const* C,
     long Ccount, double const* Cvalues, char const* S)
     {
+        bool nullInstanceFlag = true;
+        destroy(nullInstanceFlag);
         create(V,Vcount,C,Ccount, Cvalues, S);
     }
 
@@ -1063,83 +1703,122 @@ protected:
     }
 
 
-    long create(const char** V, long Vcount, const char** C,  long Ccount, double const* Cvalues, char const* S)
+    long create(const char* const* V, long Vcount, const char* const* C,  long Ccount, double const* Cvalues, char const* S)
     {
         std::string          Sstring(S);
     	Sstring = cleanUpInput(Sstring);
 
+        std::shared_ptr<SymFunProgram> P;
+
+        if(memoryResource != 0)
+        {P = std::allocate_shared<SymFunProgram>(SymFunAllocator<SymFunProgram>(memoryResource));}
+        else
+        {P = std::make_shared<SymFunProgram>();}
+
+        long expReturn = P->create(V,Vcount,C,Ccount,Cvalues,Sstring.c_str(),memoryResource);
+        if(expReturn != 0) {destroy(); return 1;}
+
+        program = P;
+        setProgramData();
+        constantValues = program->constantValues;
+        return 0;
+    }
+
     //
-    //  Allocate Storage and Initalize
+    // Adds the program of F to the program assembled by B and returns the operand
+    // of its value; S is set to the parenthesized constructor string of F. A null
+    // instance is the function 0.
     //
-    	size_t Ssize = Sstring.size();
 
-        constructorString = new char[Ssize + 1];
-        COPYSTR(constructorString, Ssize + 1,Sstring.c_str());
+    static long addOperand(SymFunProgramBuilder& B, const SymFun& F, std::string& S)
+    {
+        if(!F.program) {S = "0"; return B.addLiteral("0");}
 
-        variableCount  = Vcount;
-        if(Vcount > 0)
-        {
-           variableNames  = new char*[Vcount];
-        }
+        S = "(" + F.getConstructorString() + ")";
+        return B.addProgram(*F.program,0,F.constantValues);
+    }
 
+    //
+    // Adds the numeric constant c to the program assembled by B and returns its operand.
+    // Numeric constants are non-negative (as in the programs of expressions), so a
+    // negative value is the unary minus of its magnitude. The constant is written with
+    // the fewest digits (15 or 17) that reproduce its value.
+    //
 
-        long i;
-        for(i = 0; i < Vcount; i++)
+    static long addOperand(SymFunProgramBuilder& B, double c, std::string& S)
+    {
+        std::ostringstream sOut;
+        sOut.precision(15);
+        sOut << ((c < 0.0) ? -c : c);
+        if(atof(sOut.str().c_str()) != ((c < 0.0) ? -c : c))
         {
-        variableNames[i] = new char[strlen(V[i]) + 1];
-        COPYSTR(variableNames[i], strlen(V[i]) + 1,V[i]);
+            sOut.str("");
+            sOut.precision(17);
+            sOut << ((c < 0.0) ? -c : c);
         }
 
-        constantCount  = Ccount;
+        long operand = B.addLiteral(sOut.str());
+        S = sOut.str();
 
-        if(Ccount > 0)
+        if(c < 0.0)
         {
-        constantNames  = new char*[Ccount];
-        constantValues = new double[Ccount];
-        }
-
-        for(i = 0; i < Ccount; i++)
-        {
-        constantNames[i] = new char[strlen(C[i]) + 1];
-        COPYSTR(constantNames[i], strlen(C[i]) + 1,C[i]);
-        constantValues[i] = Cvalues[i];
+            operand = B.addOperation(RealOperatorLib().getUnaryOperatorIndex("-"),&operand,1);
+            S = "(-" + S + ")";
         }
+        return operand;
+    }
 
-        RealOperatorLib L;
-        ExpressionTransform T;
+    //
+    // Returns the SCC::SymFun A op B, where op is one of the binary operators "+","-","*","/"
+    // and A and B are SCC::SymFun instances or doubles.
+    //
 
-        long expReturn;
+    template<class TA, class TB>
+    static SymFun combine(const TA& A, const TB& B, const char* op)
+    {
+        SymFunProgramBuilder P;
+        std::string SA;
+        std::string SB;
+        long args[2];
 
-        expReturn =  T.initialize(variableNames, variableCount, constantNames,
-                     constantCount,constructorString,&L);
-        if(expReturn != 0) {destroy(); return 1;}
+        args[0] = addOperand(P,A,SA);
+        args[1] = addOperand(P,B,SB);
 
-        evaluationDataSize = T.getEvaluationDataSize();
-        evaluationData     = new double[evaluationDataSize];
+        RealOperatorLib L;
+        long functionIndex = (L.getBinaryOperatorIndex(op) >= 0) ? L.getBinaryOperatorIndex(op) : L.getOperatorIndex(op);
+        long r = P.addOperation(functionIndex,args,2);
 
-        executionArraySize = T.getExecutionArraySize();
-        executionArray     = new long[executionArraySize];
+        SymFun R;
+        std::vector<long> outputSlots;
+        R.create(P,&r,1,outputSlots,SA + op + SB);
+        return R;
+    }
 
-        initializeEvaluationData(T);
-        initializeExecutionArray(T);
     //
-    //  Save symbols
+    // Creates the instance from the program assembled by B that computes the values of
+    // the operands outputs[0], ..., outputs[outputCount-1]; the instance evaluates to the
+    // last output and outputSlots[j] is set to the data slot of the jth output (see
+    // SCC::SymFunProgramBuilder::create). S is the constructor string.
     //
-        symbolCount    = T.getSymbolCount();
-        char** TsNames = T.getSymbolNamesPtr();
 
-        if(symbolCount > 0)
-        {
-        sNames      = new char*[symbolCount];
-        }
+    long create(SymFunProgramBuilder& B, const long* outputs, long outputCount,
+                std::vector<long>& outputSlots, const std::string& S)
+    {
+        destroy();
 
-        for(i=0; i< symbolCount; i++)
-        {
-        sNames[i] = new char[strlen(TsNames[i])+1];
-        COPYSTR(sNames[i], strlen(TsNames[i]) + 1,TsNames[i]);
-        }
+        std::shared_ptr<SymFunProgram> P;
+
+        if(memoryResource != 0)
+        {P = std::allocate_shared<SymFunProgram>(SymFunAllocator<SymFunProgram>(memoryResource));}
+        else
+        {P = std::make_shared<SymFunProgram>();}
+
+        long bReturn = B.create(*P,outputs,outputCount,outputSlots,S,memoryResource);
+        if(bReturn != 0) {return 1;}
 
-        LibFunctions       = RealOpLib.FunctionArray;
+        program = P;
+        setProgramData();
+        constantValues = program->constantValues;
         return 0;
     }
 
@@ -1147,55 +1826,53 @@ protected:
 
     void destroy(bool nullInstanceFlag = false)
     {
-        if(nullInstanceFlag)
-        {
-        constructorString = 0;
+        if(nullInstanceFlag) {memoryResource = 0;}
+        else if(evaluationData != 0) {deallocateEvaluationData();}
+        evaluationData = 0;
 
-        variableNames     = 0;
-        variableCount     = 0;
-
-        constantNames     = 0;
-        constantCount     = 0;
-        constantValues    = 0;
+        program.reset();
+        setProgramData();
+        constantValues = 0;
+    }
 
-        symbolCount       = 0;
-        sNames            = 0;
+    //
+    // Returns the index of the symbolic constant named S, or -1 if there is
+    // no such constant. Names are interned in SCC::SymFunSymbolTable, so this
+    // is a symbol table lookup followed by a probe of the program's constant table.
+    //
 
-        evaluationData     = 0;
-        evaluationDataSize = 0;
+    long getConstantIndex(const std::string& S) const
+    {
+        if(constantCount == 0) return -1;
+        return program->getConstantIndex(SymFunSymbolTable::findSymbolId(S));
+    }
 
-        executionArray     = 0;
-        executionArraySize = 0;
+    //
+    // Sets the data members that cache the data of the shared program.
+    //
 
-        LibFunctions       = 0;
-        return;
-        }
+    void setProgramData()
+    {
+        if(program)
+        {
+        constructorString  = program->constructorString;
 
-        long i;
-        if(constructorString != 0) delete [] constructorString;
+        variableNames      = program->variableNames;
+        variableCount      = program->variableCount;
 
-        if(variableNames != 0)
-        {
-        for(i =0; i < variableCount; i++) delete [] variableNames[i];
-        delete [] variableNames;
-        }
+        constantNames      = program->constantNames;
+        constantCount      = program->constantCount;
 
-        if(constantNames != 0)
-        {
-        for(i =0; i < constantCount; i++) delete [] constantNames[i];
-        delete [] constantNames;
-        delete [] constantValues;
-        }
+        symbolCount        = program->symbolCount;
+        sNames             = program->sNames;
 
-        if(evaluationData != 0) delete [] evaluationData;
-        if(executionArray != 0) delete [] executionArray;
+        executionArray     = program->executionArray;
+        executionArraySize = program->executionArraySize;
 
-        if(sNames         != 0)
-        {
-        for(i=0; i< symbolCount; i++) if(sNames[i] != 0) delete [] sNames[i];
-        delete [] sNames;
+        evaluationDataSize = program->evaluationDataSize;
         }
-
+        else
+        {
         constructorString = 0;
 
         variableNames     = 0;
@@ -1203,18 +1880,57 @@ protected:
 
         constantNames     = 0;
         constantCount     = 0;
-        constantValues    = 0;
 
         symbolCount       = 0;
         sNames            = 0;
 
-        evaluationData     = 0;
-        evaluationDataSize = 0;
-
         executionArray     = 0;
         executionArraySize = 0;
 
-        LibFunctions       = 0;
+        evaluationDataSize = 0;
+        }
+    }
+
+    //
+    // Returns true if the values of the symbolic constants have been set for
+    // this instance. Until then constantValues references the initial values
+    // held by the program; afterwards it references the constant values in the
+    // evaluation data, so that the constant values and the evaluation data
+    // of an instance occupy a single allocation.
+    //
+
+    bool constantsModified() const
+    {
+        return (evaluationData != 0)&&(constantValues == evaluationData + variableCount);
+    }
+
+    void setInstanceConstants()
+    {
+        if(evaluationData == 0) createEvaluationData();
+        constantValues = evaluationData + variableCount;
+    }
+
+    //
+    // Allocates and initializes the evaluation data used by the
+    // evaluation operators.
+    //
+
+    void createEvaluationData() const
+    {
+        if(memoryResource != 0)
+        {evaluationData = (double*)memoryResource->allocate(evaluationDataSize*sizeof(double),alignof(double));}
+        else
+        {evaluationData = new double[evaluationDataSize];}
+
+        initializeEvaluationData(evaluationData);
+    }
+
+    void deallocateEvaluationData()
+    {
+        if(memoryResource != 0)
+        {memoryResource->deallocate(evaluationData,evaluationDataSize*sizeof(double),alignof(double));}
+        else
+        {delete [] evaluationData;}
     }
 
     //
@@ -1285,7 +2001,7 @@ protected:
     */
 
 
-    long initialize(const char** V, long Vcount, char const* S)
+    long initialize(const char* const* V, long Vcount, char const* S)
     {
         destroy();
         const char** C  = 0;
@@ -1348,7 +2064,7 @@ protected:
              << f(1.0) << std::endl;
     \endcode
     */
-    long initialize(const char** V, long Vcount, const char** C,
+    long initialize(const char* const* V, long Vcount, const char* const* C,
     long Ccount, double const* Cvalues, char const* S)
     {
         destroy();
@@ -1364,59 +2080,61 @@ protected:
         return symbolCount;
     }
 
-
-    char** getVariableNamePtr() const
+    const char* const* getVariableNamePtr() const
     {
         return variableNames;
     }
 
-    char** getConstantNamePtr() const
+    const char* const* getConstantNamePtr() const
     {
         return constantNames;
     }
 
-    double* getConstantValuePtr() const
+    const double* getConstantValuePtr() const
     {
         return  constantValues;
     }
-    void  initializeEvaluationData(const ExpressionTransform& T)
-    {
-        long symbolCount = T.getSymbolCount();
-        char**sNames     = T.getSymbolNamesPtr();
-        long i;  long j;
-
-        if(variableCount != 0)
-        for(i = 0; i < variableCount; i++)
-        evaluationData[i] = 0.0;
+    //
+    // Initializes the evaluation data array data : variables are set to 0,
+    // followed by the values of the symbolic and numeric constants.
+    //
 
-        for(i = variableCount,j = 0; i < variableCount + constantCount; i++,j++)
-        evaluationData[i] = constantValues[j];
+    void  initializeEvaluationData(double* data) const
+    {
+        const double* initialData = program->initialData;
+        long i;
 
-        for(i = variableCount + constantCount; i < symbolCount; i++)
-        {evaluationData[i] = atof(sNames[i]);}
+        for(i = 0; i < evaluationDataSize; i++)
+        {data[i] = initialData[i];}
 
+        for(i = 0; i < constantCount; i++)
+        {data[variableCount + i] = constantValues[i];}
     }
 
-    void  initializeExecutionArray(const ExpressionTransform& T)
+
+    double evaluate() const
     {
-        long* executionArrayPtr = T.getExecutionArrayPtr();
-        long i;
-        for(i=0; i < executionArraySize; i++)
-        {executionArray[i] = executionArrayPtr[i];
-        }
+        return evaluate(evaluationData);
     }
 
-    void  setConstantEvaluationData()
-    {
-        long i; long j;
+    //
+    // Executes the program using evaluationData as the data array.
+    //
 
-        for(i = variableCount,j = 0; i < variableCount + constantCount; i++,j++)
-        evaluationData[i] = constantValues[j];
+    double evaluate(double* evaluationData) const
+    {
+        return evaluate(evaluationData,executionArray,executionArraySize);
     }
 
+    //
+    // Executes the program in executionArray[0], ..., executionArray[executionArraySize-1]
+    // using evaluationData as the data array.
+    //
 
-    double evaluate() const
+    double evaluate(double* evaluationData, const long* executionArray, long executionArraySize) const
     {
+        void* const* LibFunctions = RealOperatorLib::getFunctionArray();
+
         long j;
         double* argData[10];   // limit of 10 args for now
 
@@ -1439,6 +2157,462 @@ protected:
         return evaluationData[evaluationDataSize - 1];
     }
 
+    //
+    // Description of the input and output arrays of a batch evaluation.
+    //
+    // The data slots 0 <= i < inputCount (the variables, or the variables and the
+    // symbolic constants) are taken from the arrays x[i]; the remaining constant
+    // slots are taken from the evaluation data. The value of input i at point k is
+    // x[i][p], where p = index[k] if index is non-null and p = k otherwise. If strides
+    // is non-null the value is at (char*)x[i] + p*strides[i].
+    //
+    // The value at point k is combined, as specified by outputOperation and
+    // outputScale (see SCC::SymFunOutputMode), with f[k], or with f[index[k]] if
+    // scatter is true.
+    //
+    // If reduction is non-null the values are not stored, but accumulated in
+    // reduction[0], or, if reductionPerBlock is true, in reduction[k/blockSize] for
+    // the block starting at point k.
+    //
+    // If outputSlots is non-null the values of the outputCount data slots outputSlots[j]
+    // are stored in the arrays outputArrays[j] (in place of the value of the program).
+    //
+    // If uniform is non-null the data slots i with uniform[i] != 0 have the same value
+    // at all points (the value in the evaluation data); such inputs are not read, and
+    // executionArray, executionArraySize specify the program used in place of the
+    // program of the instance (see createBroadcastProgram).
+    //
+
+    template<class T>
+    class BatchArrays
+    {
+    public:
+
+        BatchArrays(const T* const* x, long inputCount, T* f)
+        {
+            this->x          = x;
+            this->strides    = 0;
+            this->index      = 0;
+            this->inputCount = inputCount;
+            this->f          = f;
+            this->scatter         = false;
+            this->outputOperation = SymFunOutputMode::OVERWRITE;
+            this->outputScale     = 1.0;
+
+            this->uniform            = 0;
+            this->executionArray     = 0;
+            this->executionArraySize = 0;
+
+            this->reduction          = 0;
+            this->reductionPerBlock  = false;
+
+            this->outputArrays       = 0;
+            this->outputSlots        = 0;
+            this->outputCount        = 0;
+        }
+
+        bool isUniform(long i) const
+        {
+            return (uniform != 0)&&(uniform[i] != 0);
+        }
+
+        // Returns true if input i is read in place for the points k, ..., k + m - 1
+
+        bool isContiguous(long i) const
+        {
+            return (index == 0)&&((strides == 0)||(strides[i] == (long)sizeof(T)));
+        }
+
+        const T* getInputPtr(long i, long k) const
+        {
+            long p = (index != 0) ? (long)index[k] : k;
+            if(strides == 0) return x[i] + p;
+            return (const T*)((const char*)x[i] + p*strides[i]);
+        }
+
+        const T* const* x;
+        const long*     strides;
+        const int64_t*  index;
+        long            inputCount;
+        T*              f;
+        bool            scatter;
+        long            outputOperation;
+        double          outputScale;
+
+        const char*     uniform;
+        const long*     executionArray;
+        long            executionArraySize;
+
+        SymFunReduction* reduction;
+        bool             reductionPerBlock;
+
+        T* const*        outputArrays;
+        const long*      outputSlots;
+        long             outputCount;
+    };
+
+    //
+    // Batch evaluation of the points 0 <= k < n for each of the dataCount evaluation
+    // data arrays data[d*evaluationDataSize], ... ; the results for the dth array are
+    // written to f + d*n.
+    //
+
+    template<class T>
+    void evaluatePlan(const BatchArrays<T>& A, const double* data, long dataCount, long n,
+                      const SymFunEvaluationPlan& plan) const
+    {
+        if(plan.backend == SymFunEvaluationPlan::SCALAR)
+        {
+            for(long d = 0; d < dataCount; d++)
+            {evaluateScalar(A,data + d*evaluationDataSize,d*n,0,n);}
+        }
+        else if((plan.backend == SymFunEvaluationPlan::THREADED)&&(plan.threadCount > 1)
+              &&(!A.scatter))
+        {
+            evaluateThreaded(A,data,dataCount,n,plan.blockSize,plan.threadCount);
+        }
+        else
+        {
+            evaluateBlocks(A,data,dataCount,n,0,n,plan.blockSize);
+        }
+    }
+
+    //
+    // Scalar interpreter applied to the points kBegin <= k < kEnd using
+    // a private copy of the evaluation data initialData. The results are written
+    // at offset fOffset of the output.
+    //
+
+    void evaluateScalar(const BatchArrays<double>& A, const double* initialData, long fOffset,
+                        long kBegin, long kEnd) const
+    {
+        std::vector<double> data(initialData,initialData + evaluationDataSize);
+        double* f = A.f + fOffset;
+        double  value;
+
+        const long* program     = (A.uniform != 0) ? A.executionArray     : executionArray;
+        long        programSize = (A.uniform != 0) ? A.executionArraySize : executionArraySize;
+
+        for(long k = kBegin; k < kEnd; k++)
+        {
+            for(long i = 0; i < A.inputCount; i++)
+            {
+            if(!A.isUniform(i)) data[i] = *A.getInputPtr(i,k);
+            }
+            value = evaluate(&data[0],program,programSize);
+
+            if(A.outputSlots != 0)
+            {
+                for(long j = 0; j < A.outputCount; j++)
+                {storeResults(A,&data[A.outputSlots[j]],A.outputArrays[j],k,1);}
+            }
+            else
+            {
+                storeResults(A,&value,f,k,1);
+            }
+        }
+    }
+
+    //
+    // Scalar interpreter for float values : the float block operators are
+    // applied to blocks of one value.
+    //
+
+    void evaluateScalar(const BatchArrays<float>& A, const double* initialData, long fOffset,
+                        long kBegin, long kEnd) const
+    {
+        BatchArrays<float> B(A);
+        B.f = A.f + fOffset;
+        evaluateBlocks(B,initialData,1,0,kBegin,kEnd,1);
+    }
+
+    static void* const* getBlockFunctions(const double*) {return RealOperatorLib::getBlockFunctionArray();}
+    static void* const* getBlockFunctions(const float*)  {return RealOperatorLib::getFloatBlockFunctionArray();}
+
+    //
+    // Block interpreter applied to the points kBegin <= k < kEnd for each of the
+    // dataCount evaluation data arrays (see evaluatePlan).
+    //
+    // Each data index is associated with an array of blockSize values. Symbolic
+    // and numeric constants (and other uniform data) are broadcast once for each evaluation data array, the
+    // arguments associated with contiguous inputs reference the input arrays directly,
+    // strided and indexed inputs are gathered into the block array of their data index.
+    // The result of the last operation is written directly into f, or, for scattered
+    // output and output operations other than OVERWRITE, into the block array of the
+    // result which is then combined with f.
+    //
+
+    template<class T>
+    void evaluateBlocks(const BatchArrays<T>& A, const double* data, long dataCount,
+                        long n, long kBegin, long kEnd, long blockSize) const
+    {
+        if(blockSize < 1) blockSize = 1;
+
+        void* const* blockFunctions = getBlockFunctions(A.f);
+
+        std::vector<T>    blockData(evaluationDataSize*blockSize);
+        std::vector<T*>   dataPtr(evaluationDataSize);
+
+        long resultIndex = evaluationDataSize - 1;
+        T*   resultBlock = &blockData[resultIndex*blockSize];
+
+        const long* program     = (A.uniform != 0) ? A.executionArray     : executionArray;
+        long        programSize = (A.uniform != 0) ? A.executionArraySize : executionArraySize;
+
+        // Overwritten packed results are written by the last operation directly
+
+        bool directStore = (!A.scatter)&&(A.outputOperation == SymFunOutputMode::OVERWRITE)
+                         &&(A.reduction == 0)&&(A.outputSlots == 0);
+
+        long j;
+        T* argData[10];   // limit of 10 args for now
+
+        long functionIndex;
+        long argCount;
+        long executionIndex;
+        long m;
+
+        for(long d = 0; d < dataCount; d++)
+        {
+            const double* dData = data + d*evaluationDataSize;
+            T*            dF    = A.f  + d*n;
+
+            for(long i = 0; i < evaluationDataSize; i++)
+            {
+                dataPtr[i] = &blockData[i*blockSize];
+            }
+
+            for(long i = 0; i < evaluationDataSize; i++)
+            {
+                if(((i >= A.inputCount)&&(i < symbolCount))||A.isUniform(i))
+                {std::fill(dataPtr[i], dataPtr[i] + blockSize, (T)dData[i]);}
+            }
+
+            for(long k = kBegin; k < kEnd; k += blockSize)
+            {
+                m = (kEnd - k < blockSize) ? kEnd - k : blockSize;
+
+                for(long i = 0; i < A.inputCount; i++)
+                {
+                    if(A.isUniform(i)) continue;
+
+                    if(A.isContiguous(i))
+                    {
+                        dataPtr[i] = const_cast<T*>(A.x[i]) + k;
+                    }
+                    else
+                    {
+                        dataPtr[i] = &blockData[i*blockSize];
+                        gatherInput(A,i,k,m,dataPtr[i]);
+                    }
+                }
+                dataPtr[resultIndex] = directStore ? dF + k : resultBlock;
+
+                executionIndex = 0;
+                while(executionIndex < programSize)
+                {
+                functionIndex = program[executionIndex]; executionIndex++;
+                argCount      = program[executionIndex]; executionIndex++;
+                for(j =0; j < argCount; j++)
+                {
+                argData[j] = dataPtr[program[executionIndex]];
+                executionIndex++;
+                }
+                ((void(*)(T**,long))blockFunctions[functionIndex])(argData,m);
+                }
+
+                if(A.reduction != 0)
+                {
+                    A.reduction[A.reductionPerBlock ? k/blockSize : 0].accumulate(resultBlock,k,m);
+                }
+                else if(A.outputSlots != 0)
+                {
+                    for(j = 0; j < A.outputCount; j++)
+                    {storeResults(A,dataPtr[A.outputSlots[j]],A.outputArrays[j],k,m);}
+                }
+                else if(!directStore)
+                {
+                    storeResults(A,resultBlock,dF,k,m);
+                }
+            }
+        }
+    }
+
+    //
+    // Combines the values r[0], ... ,r[m-1] at points k, ... ,k+m-1 with f
+    // as specified by the output operation.
+    //
+
+    template<class T>
+    static void storeResults(const BatchArrays<T>& A, const T* r, T* f, long k, long m)
+    {
+        T alpha = (T)A.outputScale;
+
+        if(!A.scatter)
+        {
+            T* y = f + k;
+            switch(A.outputOperation)
+            {
+            case SymFunOutputMode::ADD        : for(long q = 0; q < m; q++) {y[q] += r[q];}       break;
+            case SymFunOutputMode::SCALED_ADD : for(long q = 0; q < m; q++) {y[q] += alpha*r[q];} break;
+            case SymFunOutputMode::MULTIPLY   : for(long q = 0; q < m; q++) {y[q] *= r[q];}       break;
+            default                           : for(long q = 0; q < m; q++) {y[q]  = r[q];}       break;
+            }
+        }
+        else
+        {
+            const int64_t* index = A.index + k;
+            switch(A.outputOperation)
+            {
+            case SymFunOutputMode::ADD        : for(long q = 0; q < m; q++) {f[index[q]] += r[q];}       break;
+            case SymFunOutputMode::SCALED_ADD : for(long q = 0; q < m; q++) {f[index[q]] += alpha*r[q];} break;
+            case SymFunOutputMode::MULTIPLY   : for(long q = 0; q < m; q++) {f[index[q]] *= r[q];}       break;
+            default                           : for(long q = 0; q < m; q++) {f[index[q]]  = r[q];}       break;
+            }
+        }
+    }
+
+    //
+    // Partially evaluates the program for a batch in which the data slots with
+    // uniform[i] != 0 (on input, the variables with scalar values and the symbolic
+    // and numeric constants) have the same value at all points. Each operation whose
+    // arguments are all uniform is evaluated once, its result stored in data, and its result
+    // slot marked uniform; the remaining operations are copied to program. Each operation
+    // writes a distinct temporary, so the stored results are not overwritten.
+    //
+
+    void createBroadcastProgram(double* data, std::vector<char>& uniform, std::vector<long>& program) const
+    {
+        void* const* LibFunctions = RealOperatorLib::getFunctionArray();
+
+        long j;
+        double* argData[10];   // limit of 10 args for now
+
+        long functionIndex;
+        long argCount;
+        bool uniformArgs;
+
+        program.clear();
+
+        long executionIndex = 0;
+        while(executionIndex < executionArraySize)
+        {
+        functionIndex = executionArray[executionIndex];
+        argCount      = executionArray[executionIndex + 1];
+        const long* op   = executionArray + executionIndex;
+        const long* args = op + 2;
+
+        // The last argument is the result
+
+        uniformArgs = true;
+        for(j = 0; j < argCount - 1; j++) {if(!uniform[args[j]]) uniformArgs = false;}
+
+        if(uniformArgs)
+        {
+            for(j = 0; j < argCount; j++) {argData[j] = &data[args[j]];}
+            ((void(*)(double**))LibFunctions[functionIndex])(argData);
+            uniform[args[argCount - 1]] = 1;
+        }
+        else
+        {
+            program.insert(program.end(), op, args + argCount);
+            uniform[args[argCount - 1]] = 0;
+        }
+
+        executionIndex += argCount + 2;
+        }
+    }
+
+    //
+    // Copies the values of input i at points k <= q < k+m to buffer. For
+    // strided and indexed input the values prefetchDistance points ahead are
+    // prefetched.
+    //
+
+    enum {prefetchDistance = 16};
+
+    template<class T>
+    static void gatherInput(const BatchArrays<T>& A, long i, long k, long m, T* buffer)
+    {
+        long stride = (A.strides != 0) ? A.strides[i] : (long)sizeof(T);
+        const char* x = (const char*)A.x[i];
+
+        if(A.index == 0)
+        {
+            const char* p = x + k*stride;
+            for(long q = 0; q < m; q++)
+            {
+                SCC_SYMFUN_PREFETCH(p + (q + prefetchDistance)*stride);
+                buffer[q] = *(const T*)(p + q*stride);
+            }
+        }
+        else
+        {
+            const int64_t* index = A.index + k;
+            for(long q = 0; q < m; q++)
+            {
+                if(q + prefetchDistance < m) {SCC_SYMFUN_PREFETCH(x + index[q + prefetchDistance]*stride);}
+                buffer[q] = *(const T*)(x + index[q]*stride);
+            }
+        }
+    }
+
+    //
+    // Divides the work among threadCount threads, each of which uses the block interpreter.
+    // When there are at least as many evaluation data arrays as threads each thread is assigned a
+    // contiguous range of the arrays, otherwise each thread is assigned a contiguous range
+    // of the points whose size is a multiple of the block size.
+    //
+
+    template<class T>
+    void evaluateThreaded(const BatchArrays<T>& A, const double* data, long dataCount, long n,
+                          long blockSize, long threadCount) const
+    {
+        if(blockSize < 1) blockSize = 1;
+
+        std::vector<std::thread> threads;
+
+        if(dataCount >= threadCount)
+        {
+            long chunkSize = (dataCount + threadCount - 1)/threadCount;
+
+            std::vector< BatchArrays<T> > chunkArrays;
+            for(long d = chunkSize; d < dataCount; d += chunkSize)
+            {
+                chunkArrays.push_back(A);
+                chunkArrays.back().f = A.f + d*n;
+            }
+
+            long c = 0;
+            for(long d = chunkSize; d < dataCount; d += chunkSize, c++)
+            {
+                long dCount = (d + chunkSize < dataCount) ? chunkSize : dataCount - d;
+                threads.push_back(std::thread(&SymFun::evaluateBlocks<T>,this,std::cref(chunkArrays[c]),
+                                  data + d*evaluationDataSize,dCount,n,0,n,blockSize));
+            }
+
+            evaluateBlocks(A,data,chunkSize,n,0,n,blockSize);
+
+            for(size_t t = 0; t < threads.size(); t++) {threads[t].join();}
+        }
+        else
+        {
+            long blockCount  = (n + blockSize - 1)/blockSize;
+            long chunkSize   = ((blockCount + threadCount - 1)/threadCount)*blockSize;
+
+            for(long k = chunkSize; k < n; k += chunkSize)
+            {
+                long kEnd = (k + chunkSize < n) ? k + chunkSize : n;
+                threads.push_back(std::thread(&SymFun::evaluateBlocks<T>,this,std::cref(A),
+                                  data,dataCount,n,k,kEnd,blockSize));
+            }
+
+            evaluateBlocks(A,data,dataCount,n,0,(chunkSize < n) ? chunkSize : n,blockSize);
+
+            for(size_t t = 0; t < threads.size(); t++) {threads[t].join();}
+        }
+    }
+
 
   // Usefull string utlities, included as members to remove dependencies.
 
@@ -1467,31 +2641,37 @@ protected:
 
 
 
+    std::shared_ptr<const SymFunProgram> program;        // compiled program and symbol tables
+
+    mutable double* evaluationData;                      // allocated on first evaluation or
+                                                         // when a constant value is set
+
+    SymFunMemoryResource* memoryResource;                // source of the data (0 = new)
+
+    //
+    // Data cached from the program
+    //
+
     char*       constructorString;
 
-    char**      variableNames;
-    long         variableCount;
+    const char* const* variableNames;
+    long        variableCount;
 
-    char**      constantNames;
+    const char* const* constantNames;
     long        constantCount;
-    double*     constantValues;
+    double*     constantValues;   // program values or evaluationData + variableCount
 
-    long        symbolCount;      // total number of variables, symbolic constants, 
-                                  // and numeric constants 
+    long        symbolCount;      // total number of variables, symbolic constants,
+                                  // and numeric constants
 
     long*       executionArray;
     long        executionArraySize;
 
-    double*     evaluationData;
     long        evaluationDataSize;
 
-    void** LibFunctions;
-
-    char   **sNames;
+    const char* const* sNames;
 
     /* void createCcode(); // experimenting 02/19/07 */
-
-    RealOperatorLib RealOpLib;
 };
 }
 
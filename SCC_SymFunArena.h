@@ -0,0 +1,201 @@
+//
+//##################################################################
+//                     SCC_SymFunArena.h
+//##################################################################
+//
+// A memory arena for building populations of SCC::SymFun instances
+// that are released together.
+//
+// Chris Anderson (C) UCLA 2022
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <cstdint>
+#include <new>
+#include <vector>
+#include <string>
+
+#include "SCC_SymFun.h"
+#include "SCC_SymFunMemoryResource.h"
+
+#ifndef SYMFUN_ARENA_
+#define SYMFUN_ARENA_
+
+namespace SCC
+{
+
+/*!
+ \class SCC::SymFunArena
+ \brief A memory arena from which populations of SCC::SymFun instances are allocated and released together
+
+ An SCC::SymFunArena is a monotonic memory resource: memory is allocated sequentially from
+ large chunks, deallocation is a no-op, and all of the memory is returned with release().
+ It implements the SCC::SymFunMemoryResource interface, so it can be used with the SymFun constructor
+ that accepts a memory resource, with SymFun::setMemoryResource(...) and, with C++17, through an
+ SCC::SymFunPMRresource, as the memory resource of std::pmr containers.
+
+ Instances created with createSymFun(...) are placed in the arena themselves; release() destroys them
+ (no memory is freed individually) and then frees the chunks. Instances created elsewhere that use
+ the arena, and copies of instances that use the arena, must be destroyed before release() is called.
+
+ The cost of release() is O(n) in the number n of instances created with createSymFun(...), plus
+ one deallocation per chunk. The destructor of each instance is run, which only decrements the
+ reference count of its compiled program, since an instance may share a program allocated
+ outside of the arena (e.g. after assignment from an instance created elsewhere); skipping the
+ destructors would leak such programs.
+
+ An SCC::SymFunArena is not thread safe.
+
+ Sample:
+ \code
+    SCC::SymFunArena arena;
+
+    std::vector<SCC::SymFun*> F(cellCount);
+    for(long i = 0; i < cellCount; i++)
+    {
+    F[i] = arena.createSymFun(V,C,Cvalues[i],S);
+    }
+
+    ...
+
+    arena.release();      // destroys all of the instances and frees the arena memory
+ \endcode
+
+ \headerfile SCC_SymFunArena.h "SCC_SymFunArena.h"
+*/
+
+class SymFunArena : public SymFunMemoryResource
+{
+public:
+
+    /**
+     Creates an arena that allocates memory in chunks of chunkSize bytes
+     (larger requests are allocated in chunks of their own).
+    */
+
+    SymFunArena(size_t chunkSize = 65536)
+    {
+        this->chunkSize = chunkSize;
+        chunkPtr        = 0;
+        chunkRemaining  = 0;
+        bytesAllocated  = 0;
+    }
+
+    ~SymFunArena()
+    {
+        release();
+    }
+
+    /**
+     Creates an instance of SCC::SymFun(V,C,Cvalues,S) in the arena, with its program and
+     evaluation data allocated from the arena. The instance is destroyed by release().
+    */
+
+    SymFun* createSymFun(const std::vector<std::string>& V, const std::vector<std::string>& C,
+                         const std::vector<double>& Cvalues, const std::string& S)
+    {
+        void* p = allocate(sizeof(SymFun),alignof(SymFun));
+        SymFun* F = new (p) SymFun(V,C,Cvalues,S,this);
+        instances.push_back(F);
+        return F;
+    }
+
+    /**
+     Creates an instance of SCC::SymFun(V,S) in the arena.
+    */
+
+    SymFun* createSymFun(const std::vector<std::string>& V, const std::string& S)
+    {
+        return createSymFun(V,std::vector<std::string>(),std::vector<double>(),S);
+    }
+
+    /**
+     Destroys the instances created with createSymFun(...) and frees all of the memory
+     of the arena. The cost is O(n) in the number of instances (see the class description).
+    */
+
+    void release()
+    {
+        for(size_t i = 0; i < instances.size(); i++) {instances[i]->~SymFun();}
+        instances.clear();
+
+        for(size_t i = 0; i < chunks.size(); i++) {delete [] chunks[i];}
+        chunks.clear();
+
+        chunkPtr       = 0;
+        chunkRemaining = 0;
+        bytesAllocated = 0;
+    }
+
+    /**
+     Returns the number of bytes allocated from the arena since it was created or
+     last released.
+    */
+
+    size_t getBytesAllocated() const
+    {
+        return bytesAllocated;
+    }
+
+protected:
+
+    void* do_allocate(size_t bytes, size_t alignment)
+    {
+        size_t padding = (alignment - (size_t)((std::uintptr_t)chunkPtr % alignment)) % alignment;
+
+        if((chunkPtr == 0)||(padding + bytes > chunkRemaining))
+        {
+            size_t newChunkSize = (bytes + alignment > chunkSize) ? bytes + alignment : chunkSize;
+            chunkPtr       = new char[newChunkSize];
+            chunkRemaining = newChunkSize;
+            chunks.push_back(chunkPtr);
+            padding = (alignment - (size_t)((std::uintptr_t)chunkPtr % alignment)) % alignment;
+        }
+
+        void* p = chunkPtr + padding;
+        chunkPtr       += padding + bytes;
+        chunkRemaining -= padding + bytes;
+        bytesAllocated += bytes;
+        return p;
+    }
+
+    void do_deallocate(void*, size_t, size_t)
+    {}
+
+    bool do_is_equal(const SymFunMemoryResource& other) const noexcept
+    {
+        return this == &other;
+    }
+
+    size_t             chunkSize;
+    char*              chunkPtr;        // next free byte of the current chunk
+    size_t             chunkRemaining;
+    size_t             bytesAllocated;
+    std::vector<char*> chunks;
+    std::vector<SymFun*> instances;     // instances created with createSymFun(...)
+
+private:
+
+    SymFunArena(const SymFunArena&);
+    SymFunArena& operator=(const SymFunArena&);
+};
+}
+#endif
@@ -0,0 +1,273 @@
+//
+//##################################################################
+//                     SCC_SymFunBinding.h
+//##################################################################
+//
+// A class for evaluating an SCC::SymFun whose variables are bound to
+// caller owned memory, either to fixed addresses or to field offsets
+// within a record.
+//
+// Chris Anderson (C) UCLA 2022
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <cstddef>
+#include <vector>
+#include <string>
+
+#include "SCC_SymFun.h"
+#include "SCC_RealOperatorLib.h"
+#include "SCC_SymFunSymbolTable.h"
+
+#ifndef SYMFUN_BINDING_
+#define SYMFUN_BINDING_
+
+namespace SCC
+{
+
+/*!
+ \class SCC::SymFunBinding
+ \brief A class for evaluating an SCC::SymFun whose variables are read directly from caller owned memory
+
+ Each variable of an SCC::SymFunBinding may be bound once to the address of a double, or to the byte
+ offset of a double field within a record (e.g. a struct). The operands of the evaluation are then read
+ directly from the bound memory: the variable values are not copied.
+
+ evaluate() evaluates the function using the values at the bound addresses. evaluate(record) first
+ locates the variables bound to offsets within the record and then evaluates the function. Variables
+ that are not bound have the value 0.
+
+ The SCC::SymFunBinding shares the compiled program of the SCC::SymFun it is constructed from; constructing
+ an instance from a null SCC::SymFun generates an SCC::SymFunException. Bound
+ memory must remain valid while it is used for evaluation. An instance should not be used for evaluation
+ by more than one thread at a time.
+
+ Sample:
+ \code
+    struct Particle {double x; double y; double mass;};
+
+    SCC::SymFun F({"x","y","m"},"m*(x^2 + y^2)");
+    SCC::SymFunBinding B(F);
+
+    B.bindVariableOffset("x",offsetof(Particle,x));
+    B.bindVariableOffset("y",offsetof(Particle,y));
+    B.bindVariableOffset("m",offsetof(Particle,mass));
+
+    for(long k = 0; k < particleCount; k++)
+    {
+    energy[k] = B.evaluate(&particles[k]);
+    }
+
+    double t;
+    SCC::SymFunBinding G(SCC::SymFun({"t"},"sin(t)"));
+    G.bindVariable("t",&t);
+    t = 1.0; double g = G.evaluate();
+ \endcode
+
+ \headerfile SCC_SymFunBinding.h "SCC_SymFunBinding.h"
+*/
+
+class SymFunBinding
+{
+public:
+
+    SymFunBinding(const SymFun& F) : F(F)
+    {
+        variableAddresses.resize(this->F.variableCount,0);
+        variableOffsets.resize(this->F.variableCount,-1);
+        createSlots();
+    }
+
+    SymFunBinding(const SymFunBinding& B) : F(B.F),
+    variableAddresses(B.variableAddresses), variableOffsets(B.variableOffsets)
+    {
+        createSlots();
+    }
+
+    SymFunBinding& operator=(const SymFunBinding& B)
+    {
+        F                 = B.F;
+        variableAddresses = B.variableAddresses;
+        variableOffsets   = B.variableOffsets;
+        createSlots();
+        return *this;
+    }
+
+    /**
+     Binds the ith variable to the double at address x.
+    */
+
+    void bindVariable(long i, const double* x)
+    {
+        variableAddresses[i] = x;
+        variableOffsets[i]   = -1;
+        slotPtr[i] = (x != 0) ? const_cast<double*>(x) : F.evaluationData + i;
+    }
+
+    /**
+     Binds the variable named V to the double at address x. Returns
+     false if there is no variable named V.
+    */
+
+    bool bindVariable(const std::string& V, const double* x)
+    {
+        long i = getVariableIndex(V);
+        if(i < 0) return false;
+        bindVariable(i,x);
+        return true;
+    }
+
+    /**
+     Binds the ith variable to the double at byteOffset bytes from the start of the
+     record passed to evaluate(record).
+    */
+
+    void bindVariableOffset(long i, size_t byteOffset)
+    {
+        variableAddresses[i] = 0;
+        variableOffsets[i]   = (long)byteOffset;
+        slotPtr[i] = F.evaluationData + i;
+    }
+
+    /**
+     Binds the variable named V to the double at byteOffset bytes from the start of the
+     record passed to evaluate(record). Returns false if there is no variable named V.
+    */
+
+    bool bindVariableOffset(const std::string& V, size_t byteOffset)
+    {
+        long i = getVariableIndex(V);
+        if(i < 0) return false;
+        bindVariableOffset(i,byteOffset);
+        return true;
+    }
+
+    /**
+     Returns the value of the function using the values at the bound addresses.
+    */
+
+    double evaluate() const
+    {
+        void* const* LibFunctions = RealOperatorLib::getFunctionArray();
+
+        const long* executionArray     = F.executionArray;
+        long        executionArraySize = F.executionArraySize;
+        double* const* slots           = &slotPtr[0];
+
+        long j;
+        double* argData[10];   // limit of 10 args for now
+
+        long functionIndex;
+        long argCount;
+
+        long executionIndex = 0;
+        while(executionIndex < executionArraySize)
+        {
+        functionIndex = executionArray[executionIndex]; executionIndex++;
+        argCount      = executionArray[executionIndex]; executionIndex++;
+        for(j =0; j < argCount; j++)
+        {
+        argData[j] = slots[executionArray[executionIndex]];
+        executionIndex++;
+        }
+        ((void(*)(double**))LibFunctions[functionIndex])(argData);
+        }
+
+        return *slots[F.evaluationDataSize - 1];
+    }
+
+    /**
+     Returns the value of the function where the variables bound to offsets are read
+     from the record starting at address record.
+    */
+
+    double evaluate(const void* record) const
+    {
+        for(long i = 0; i < F.variableCount; i++)
+        {
+        if(variableOffsets[i] >= 0)
+        {slotPtr[i] = (double*)((char*)const_cast<void*>(record) + variableOffsets[i]);}
+        }
+        return evaluate();
+    }
+
+    void setConstantValue(const std::string& C, double x)
+    {
+        F.setConstantValue(C,x);
+    }
+
+    void setConstant(const SymFun::ConstantHandle& h, double x)
+    {
+        F.setConstant(h,x);
+    }
+
+    const SymFun& getSymFun() const
+    {
+        return F;
+    }
+
+protected:
+
+    long getVariableIndex(const std::string& V) const
+    {
+        long id = SymFunSymbolTable::findSymbolId(V);
+        for(long i = 0; i < F.variableCount; i++)
+        {
+        if(F.program->variableIds[i] == id) return i;
+        }
+        return -1;
+    }
+
+    //
+    // Creates the table of operand addresses: bound variables reference the caller's
+    // memory, all other data slots reference the evaluation data of F. Operation results
+    // are always written to temporaries, so the caller's memory is only read.
+    //
+    // A null SCC::SymFun has no result slot to evaluate to, so binding one generates
+    // an SCC::SymFunException.
+    //
+
+    void createSlots()
+    {
+        if((F.program == 0)||(F.evaluationDataSize == 0))
+        {
+            throw SymFunException("SymFunBinding of a null SymFun",
+                                  "The SymFun has not been initialized","");
+        }
+
+        if(F.evaluationData == 0) F.createEvaluationData();
+
+        slotPtr.resize(F.evaluationDataSize);
+        for(long i = 0; i < F.evaluationDataSize; i++) {slotPtr[i] = F.evaluationData + i;}
+
+        for(long i = 0; i < F.variableCount; i++)
+        {
+        if(variableAddresses[i] != 0) {slotPtr[i] = const_cast<double*>(variableAddresses[i]);}
+        }
+    }
+
+    SymFun                      F;
+    std::vector<const double*>  variableAddresses;  // 0 if not bound to an address
+    std::vector<long>           variableOffsets;    // -1 if not bound to an offset
+    mutable std::vector<double*> slotPtr;           // operand address of each data slot
+};
+}
+#endif
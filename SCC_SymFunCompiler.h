@@ -0,0 +1,332 @@
+//
+//##################################################################
+//                     SCC_SymFunCompiler.h
+//##################################################################
+//
+// Classes for compiling many SCC::SymFun instances concurrently:
+// SCC::SymFunSpecification, the specification of a function, and
+// SCC::SymFunCompiler, which compiles lists of specifications using
+// a pool of threads.
+//
+// Chris Anderson (C) UCLA 2022
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <utility>
+
+#include "SCC_SymFun.h"
+
+#ifndef SYMFUN_COMPILER_
+#define SYMFUN_COMPILER_
+
+namespace SCC
+{
+
+/*!
+ \class SCC::SymFunSpecification
+ \brief A class whose instances hold the specification of an SCC::SymFun
+
+ The variable names V, the symbolic constant names C and their initial values Cvalues, and
+ the function string S, as passed to the SCC::SymFun constructors.
+
+ \headerfile SCC_SymFunCompiler.h "SCC_SymFunCompiler.h"
+*/
+
+class SymFunSpecification
+{
+public:
+
+    SymFunSpecification() {}
+
+    /**
+      Specification of the function S of the variable x.
+    */
+
+    SymFunSpecification(const std::string& S) : V(1,"x"), S(S) {}
+
+    SymFunSpecification(const std::vector<std::string>& V, const std::string& S) : V(V), S(S) {}
+
+    SymFunSpecification(const std::vector<std::string>& V, const std::vector<std::string>& C,
+                        const std::vector<double>& Cvalues, const std::string& S)
+    : V(V), C(C), Cvalues(Cvalues), S(S) {}
+
+    std::vector<std::string> V;
+    std::vector<std::string> C;
+    std::vector<double>      Cvalues;
+    std::string              S;
+};
+
+/*!
+ \class SCC::SymFunCompiler
+ \brief A class for compiling lists of SCC::SymFun specifications concurrently
+
+ The specifications are compiled by a pool of threads, each of which repeatedly takes the
+ next specification that has not been compiled, so the work is balanced when the cost of
+ compiling the functions varies. An error in one specification does not stop the compilation
+ of the others: compile(...) reports the error message of each specification, and the future
+ returned for a specification by compileAsync(...) holds its exception.
+
+ The names of all functions are interned in SCC::SymFunSymbolTable, which may be accessed
+ concurrently, and compilation uses no other shared data.
+
+ Sample:
+ \code
+    std::vector<SCC::SymFunSpecification> specs;
+    specs.push_back(SCC::SymFunSpecification({"x","y"},"x^2 + y^2"));
+    specs.push_back(SCC::SymFunSpecification({"x","y"},"sin(x*y"));      // syntax error
+    ...
+
+    SCC::SymFunCompiler compiler;                 // one thread per hardware thread
+
+    std::vector<SCC::SymFun>  F;
+    std::vector<std::string>  errors;
+    long errorCount = compiler.compile(specs,F,errors);
+
+    for(size_t i = 0; i < errors.size(); i++)
+    {
+    if(!errors[i].empty()) {std::cerr << "Function " << i << " : " << errors[i] << std::endl;}
+    }
+ \endcode
+
+ \headerfile SCC_SymFunCompiler.h "SCC_SymFunCompiler.h"
+*/
+
+class SymFunCompiler
+{
+public:
+
+    /**
+      Creates an instance that compiles with threadCount threads. If threadCount is
+      less than 1, the number of hardware threads is used.
+    */
+
+    SymFunCompiler(long threadCount = 0)
+    {
+        setThreadCount(threadCount);
+    }
+
+    void setThreadCount(long threadCount)
+    {
+        if(threadCount < 1) threadCount = (long)std::thread::hardware_concurrency();
+        this->threadCount = (threadCount < 1) ? 1 : threadCount;
+    }
+
+    long getThreadCount() const
+    {
+        return threadCount;
+    }
+
+    /**
+     Compiles the specifications specs[0], ..., specs[n-1]; on return F[i] is the
+     function specified by specs[i] and errors[i] is empty, or, if the compilation of
+     specs[i] failed, F[i] is a null instance and errors[i] is the error message.
+     The calling thread is one of the threads of the pool. If a thread of the pool
+     cannot be started, the specifications are compiled by the threads that have been started.
+
+     @returns the number of specifications whose compilation failed.
+    */
+
+    long compile(const std::vector<SymFunSpecification>& specs, std::vector<SymFun>& F,
+                 std::vector<std::string>& errors) const
+    {
+        long n = (long)specs.size();
+
+        F.clear();
+        F.resize(n);
+        errors.assign(n,std::string());
+
+        std::atomic<long> next(0);
+        std::atomic<long> errorCount(0);
+
+        // Space for the threads is reserved so that a thread, once started, is always
+        // stored (and joined); a thread that cannot be started reduces the pool.
+
+        std::vector<std::thread> threads;
+        threads.reserve((threadCount < n) ? threadCount : n);
+
+        for(long t = 1; (t < threadCount)&&(t < n); t++)
+        {
+            try
+            {
+                threads.push_back(std::thread(&SymFunCompiler::compileItems,std::cref(specs),std::ref(F),
+                                  std::ref(errors),std::ref(next),std::ref(errorCount)));
+            }
+            catch(const std::system_error&)
+            {
+                break;
+            }
+        }
+
+        // If the calling thread fails, the remaining specifications are not started
+        // and the threads are joined before the exception is propagated.
+
+        try
+        {
+            compileItems(specs,F,errors,next,errorCount);
+        }
+        catch(...)
+        {
+            next.store(n);
+            joinThreads(threads);
+            throw;
+        }
+
+        joinThreads(threads);
+
+        return errorCount.load();
+    }
+
+    /**
+     Starts the compilation of the specifications specs[0], ..., specs[n-1] and returns
+     immediately. The ith future returned holds the function specified by specs[i] or,
+     if its compilation failed, the exception generated (e.g. an SCC::SymFunException),
+     which is thrown by get(). The specifications are copied.
+
+     The compilation threads are detached; the futures should be waited for before the
+     program exits. If a compilation thread cannot be started, the calling thread compiles
+     the specifications that remain before returning, so every future becomes ready.
+    */
+
+    std::vector< std::future<SymFun> > compileAsync(const std::vector<SymFunSpecification>& specs) const
+    {
+        long n = (long)specs.size();
+
+        std::shared_ptr<AsyncCompilation> C = std::make_shared<AsyncCompilation>(specs);
+
+        std::vector< std::future<SymFun> > results(n);
+        for(long i = 0; i < n; i++) {results[i] = C->promises[i].get_future();}
+
+        for(long t = 0; (t < threadCount)&&(t < n); t++)
+        {
+            try
+            {
+                std::thread(&SymFunCompiler::compileAsyncItems,C).detach();
+            }
+            catch(const std::system_error&)
+            {
+                compileAsyncItems(C);
+                break;
+            }
+        }
+
+        return results;
+    }
+
+protected:
+
+    //
+    // The state of an asynchronous compilation, shared by the compilation threads.
+    //
+
+    class AsyncCompilation
+    {
+    public:
+
+        AsyncCompilation(const std::vector<SymFunSpecification>& specs)
+        : specs(specs), promises(specs.size()), next(0) {}
+
+        std::vector<SymFunSpecification>    specs;
+        std::vector< std::promise<SymFun> > promises;
+        std::atomic<long>                   next;
+    };
+
+    //
+    // Compiles the specification S into F; initialization errors that do not
+    // generate an exception generate an SCC::SymFunException.
+    //
+
+    static void compileItem(const SymFunSpecification& S, SymFun& F)
+    {
+        long iReturn = S.C.empty() ? F.initialize(S.V,S.S) : F.initialize(S.V,S.C,S.Cvalues,S.S);
+        if(iReturn != 0)
+        {
+            throw SymFunException("SymFun initialization error","",S.S);
+        }
+    }
+
+    //
+    // Compiles the specifications with indices taken from next until all have been taken.
+    //
+
+    static void compileItems(const std::vector<SymFunSpecification>& specs, std::vector<SymFun>& F,
+                             std::vector<std::string>& errors, std::atomic<long>& next, std::atomic<long>& errorCount)
+    {
+        long n = (long)specs.size();
+        long i;
+
+        while((i = next.fetch_add(1)) < n)
+        {
+            try
+            {
+                compileItem(specs[i],F[i]);
+            }
+            catch(const std::exception& e)
+            {
+                F[i].initialize();
+                errors[i] = e.what();
+                errorCount.fetch_add(1);
+            }
+            catch(...)
+            {
+                F[i].initialize();
+                errors[i] = "Unknown exception";
+                errorCount.fetch_add(1);
+            }
+        }
+    }
+
+    static void joinThreads(std::vector<std::thread>& threads)
+    {
+        for(size_t t = 0; t < threads.size(); t++) {threads[t].join();}
+    }
+
+    static void compileAsyncItems(std::shared_ptr<AsyncCompilation> C)
+    {
+        long n = (long)C->specs.size();
+        long i;
+
+        while((i = C->next.fetch_add(1)) < n)
+        {
+            try
+            {
+                SymFun F;
+                compileItem(C->specs[i],F);
+                C->promises[i].set_value(std::move(F));
+            }
+            catch(...)
+            {
+                C->promises[i].set_exception(std::current_exception());
+            }
+        }
+    }
+
+    long threadCount;
+};
+}
+#endif
@@ -0,0 +1,82 @@
+//
+//##################################################################
+//                  SCC_SymFunEvaluationPlan.h
+//##################################################################
+//
+// A class whose instances specify how the batch evaluation member
+// functions of SCC::SymFun are to be carried out.
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+
+#ifndef SYMFUN_EVALUATION_PLAN_
+#define SYMFUN_EVALUATION_PLAN_
+
+namespace SCC
+{
+
+/*!
+ \class SCC::SymFunEvaluationPlan
+ \brief A class whose instances specify the backend, block size and thread count used for batch evaluation of an SCC::SymFun
+
+ The backends are
+
+ SCALAR   : the scalar interpreter is invoked once for each point.
+
+ BLOCK    : the block interpreter is invoked once for each block of blockSize points. Each
+            operator is applied to a block of values, so the cost of the operator dispatch is amortized over the block.
+
+ THREADED : the points are divided among threadCount threads, each of which uses the block interpreter.
+
+ Instances are typically obtained from an SCC::SymFunEvaluationPlanner.
+
+ \headerfile SCC_SymFunEvaluationPlan.h "SCC_SymFunEvaluationPlan.h"
+*/
+
+class SymFunEvaluationPlan
+{
+public:
+
+    enum {SCALAR = 0, BLOCK = 1, THREADED = 2};
+
+    /**
+     Null constructor. Creates a plan that uses the block interpreter with blocks of 256 points.
+    */
+    SymFunEvaluationPlan()
+    {
+        backend     = BLOCK;
+        blockSize   = 256;
+        threadCount = 1;
+    }
+
+    SymFunEvaluationPlan(long backend, long blockSize, long threadCount)
+    {
+        this->backend     = backend;
+        this->blockSize   = (blockSize   > 0) ? blockSize   : 1;
+        this->threadCount = (threadCount > 0) ? threadCount : 1;
+    }
+
+    long backend;
+    long blockSize;
+    long threadCount;
+};
+}
+#endif
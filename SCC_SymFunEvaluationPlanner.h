@@ -0,0 +1,483 @@
+//
+//##################################################################
+//                SCC_SymFunEvaluationPlanner.h
+//##################################################################
+//
+// A class that selects the backend and block size used for the batch
+// evaluation of SCC::SymFun instances. Plans are determined either with
+// a cost model applied to the compiled program or by timing the
+// candidate backends (autotuning). Autotuned plans can be saved to, and
+// restored from, a tuning file whose entries are keyed by the hash of the
+// compiled program, the value type, the instruction set level and the
+// CPU model.
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <string>
+#include <cstring>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+
+#include "SCC_SymFun.h"
+#include "SCC_SymFunEvaluationPlan.h"
+
+#ifndef SYMFUN_EVALUATION_PLANNER_
+#define SYMFUN_EVALUATION_PLANNER_
+
+namespace SCC
+{
+
+/*!
+ \class SCC::SymFunEvaluationPlanner
+ \brief A class whose instances select the backend and block size used for the batch evaluation of SCC::SymFun instances
+
+ Which of the scalar interpreter, the block interpreter or the threaded block interpreter is fastest depends
+ upon the length of the compiled program and the number of evaluation points. The planner determines
+ an SCC::SymFunEvaluationPlan using a cost model applied to the compiled program, or, if autotuning is enabled,
+ by timing the candidate plans the first time a program is evaluated with a batch of a given size.
+
+ When a tuning file is specified, autotuned plans are appended to the file and are used in subsequent runs.
+ Entries are keyed by the hash of the compiled program, the size class (floor(log2(n))) of the
+ batch, the value type (double or float), the instruction set level of the block operators
+ (see SCC::RealOperatorLib::getInstructionSetLevel()) and the CPU model, so that a single tuning
+ file can be shared by nodes of different types.
+
+ Autotuning is carried out without holding the lock of the planner, so threads requesting plans
+ that have been determined are not delayed by the tuning of another plan.
+
+ Required version of C++ : >=  C++11
+
+ \headerfile SCC_SymFunEvaluationPlanner.h "SCC_SymFunEvaluationPlanner.h"
+
+ <HR>
+ Sample usage
+ \code
+ SCC::SymFun F(V,S);
+
+ SCC::SymFunEvaluationPlanner planner("SymFunTuning.dat"); // autotuning with persisted plans
+
+ const double* X[] = {&x[0],&y[0]};
+ planner.evaluateBatch(F,X,n,&f[0]);
+ \endcode
+*/
+
+class SymFunEvaluationPlanner
+{
+public:
+
+    /**
+     Null constructor. Plans are determined with the cost model.
+    */
+
+    SymFunEvaluationPlanner()
+    {
+        initialize();
+    }
+
+    /**
+     Creates a planner that autotunes and persists the tuned plans in the file tuningFileName.
+    */
+
+    SymFunEvaluationPlanner(const std::string& tuningFileName)
+    {
+        initialize(tuningFileName);
+    }
+
+    void initialize()
+    {
+        std::lock_guard<std::mutex> lock(planMutex);
+        autotuneFlag     = false;
+        tuningFileName.clear();
+        tuningFileLoaded = false;
+        tunedPlans.clear();
+    }
+
+    void initialize(const std::string& tuningFileName)
+    {
+        initialize();
+        std::lock_guard<std::mutex> lock(planMutex);
+        autotuneFlag         = true;
+        this->tuningFileName = tuningFileName;
+    }
+
+    /**
+     Enables (flag = true) or disables (flag = false) autotuning. When autotuning is
+     enabled and no tuning file has been specified, tuned plans are retained in memory only.
+    */
+
+    void setAutotune(bool flag)
+    {
+        std::lock_guard<std::mutex> lock(planMutex);
+        autotuneFlag = flag;
+    }
+
+    /**
+     Returns the plan for the batch evaluation of F at n points with values of type T
+     (double or float).
+
+     If two threads request the same plan before it has been tuned, both tune it and
+     the plan of the first to finish is retained.
+    */
+
+    template<class T = double>
+    SymFunEvaluationPlan getPlan(const SymFun& F, long n)
+    {
+        std::string key = getTuningKey<T>(F,n);
+
+        {
+        std::lock_guard<std::mutex> lock(planMutex);
+
+        if(!autotuneFlag) return estimatePlan<T>(F,n);
+
+        if((!tuningFileLoaded)&&(!tuningFileName.empty()))
+        {
+            loadTuningFile();
+        }
+        tuningFileLoaded = true;
+
+        std::map<std::string,SymFunEvaluationPlan>::iterator it = tunedPlans.find(key);
+        if(it != tunedPlans.end()) return it->second;
+        }
+
+        SymFunEvaluationPlan plan = autotune<T>(F,n);
+
+        std::lock_guard<std::mutex> lock(planMutex);
+
+        std::pair<std::map<std::string,SymFunEvaluationPlan>::iterator,bool> entry
+        = tunedPlans.insert(std::make_pair(key,plan));
+
+        if(entry.second && (!tuningFileName.empty())) appendTuningFile(key,plan);
+        return entry.first->second;
+    }
+
+    /**
+     Evaluates F at n points using the plan returned by getPlan(F,n). See
+     SCC::SymFun::evaluateBatch(...) for a description of the arguments.
+    */
+
+    template<class T>
+    void evaluateBatch(const SymFun& F, const T* const* x, long n, T* f)
+    {
+        F.evaluateBatch(x,n,f,getPlan<T>(F,n));
+    }
+
+    /**
+     Returns the plan determined by the cost model for values of type T (double or float).
+
+     The cost of each operator is weighted by an estimate of its cost in cycles. The scalar interpreter
+     adds an operator dispatch to each operation at each point, the block interpreter amortizes the
+     dispatch over the block and vectorizes the operators that have vector kernels using the vector width
+     of the instruction set level selected by SCC::RealOperatorLib, and the threaded interpreter
+     divides the work of the block interpreter among the hardware threads at the cost of starting the threads.
+     The block size is the largest power of two for which the block data fits in the L1 data cache.
+    */
+
+    template<class T = double>
+    SymFunEvaluationPlan estimatePlan(const SymFun& F, long n) const
+    {
+        double scalarCost = 0.0;
+        double blockCost  = 0.0;
+        long   opCount    = 0;
+
+        const double simdWidthValues[] = {1.0, 2.0, 4.0, 8.0};   // doubles per register for each instruction set level
+        double simdWidth = simdWidthValues[RealOperatorLib::getInstructionSetLevel()]*(double)(sizeof(double)/sizeof(T));
+
+        long executionIndex = 0;
+        while(executionIndex < F.executionArraySize)
+        {
+        long functionIndex = F.executionArray[executionIndex]; executionIndex++;
+        long argCount      = F.executionArray[executionIndex]; executionIndex++;
+        executionIndex    += argCount;
+
+        const char* symbol = RealOperatorLib::Symbols[functionIndex];
+        double opCost = getOperatorCost(symbol);
+
+        scalarCost += dispatchCost + opCost;
+        blockCost  += isVectorized(symbol) ? opCost/simdWidth + memoryCost : opCost + memoryCost;
+        opCount++;
+        }
+
+        long blockSize = maxBlockSize;
+        while((blockSize > minBlockSize)&&((long)sizeof(T)*F.evaluationDataSize*blockSize > l1CacheSize)) {blockSize /= 2;}
+        while((blockSize > minBlockSize)&&(blockSize/2 >= n))                               {blockSize /= 2;}
+
+        double dn = (double)n;
+        double scalarTotal = dn*scalarCost;
+        double blockTotal  = dn*blockCost + ((dn + blockSize - 1)/blockSize)*opCount*dispatchCost
+                           + (double)(F.evaluationDataSize*blockSize);
+
+        long   threadCount    = (long)std::thread::hardware_concurrency();
+        if(threadCount > (n + blockSize - 1)/blockSize) threadCount = (n + blockSize - 1)/blockSize;
+        double threadedTotal = (threadCount > 1) ? blockTotal/threadCount + threadCount*threadStartCost : blockTotal + 1.0;
+
+        if((scalarTotal <= blockTotal)&&(scalarTotal <= threadedTotal))
+        {
+            return SymFunEvaluationPlan(SymFunEvaluationPlan::SCALAR,1,1);
+        }
+        if(blockTotal <= threadedTotal)
+        {
+            return SymFunEvaluationPlan(SymFunEvaluationPlan::BLOCK,blockSize,1);
+        }
+        return SymFunEvaluationPlan(SymFunEvaluationPlan::THREADED,blockSize,threadCount);
+    }
+
+    /**
+     Returns the fastest of the candidate plans for the batch evaluation of F at n points with values
+     of type T (double or float). The candidates are timed using at most 65536 synthetic evaluation points.
+    */
+
+    template<class T = double>
+    SymFunEvaluationPlan autotune(const SymFun& F, long n) const
+    {
+        long nTrial = (n < maxTrialSize) ? n : maxTrialSize;
+        if(nTrial < 1) nTrial = 1;
+
+        long variableCount = F.getVariableCount();
+        std::vector< std::vector<T> > xData(variableCount, std::vector<T>(nTrial));
+        std::vector< const T* >       x(variableCount + 1);
+        std::vector<T>                f(nTrial);
+
+        for(long i = 0; i < variableCount; i++)
+        {
+            for(long k = 0; k < nTrial; k++) {xData[i][k] = (T)(0.25 + (double)((k + 37*i) % 101)/101.0);}
+            x[i] = &xData[i][0];
+        }
+
+        SymFunEvaluationPlan bestPlan(SymFunEvaluationPlan::SCALAR,1,1);
+        double bestTime = timePlan(F,&x[0],nTrial,&f[0],bestPlan);
+        double planTime;
+
+        long bestBlockSize = 0;
+        for(long blockSize = minBlockSize; blockSize <= maxBlockSize; blockSize *= 2)
+        {
+            if(blockSize/2 >= nTrial) break;
+            SymFunEvaluationPlan plan(SymFunEvaluationPlan::BLOCK,blockSize,1);
+            planTime = timePlan(F,&x[0],nTrial,&f[0],plan);
+            if(planTime < bestTime) {bestTime = planTime; bestPlan = plan; bestBlockSize = blockSize;}
+        }
+
+        long threadCount = (long)std::thread::hardware_concurrency();
+        if((threadCount > 1)&&(bestBlockSize > 0)&&(nTrial >= 2*bestBlockSize))
+        {
+            if(threadCount > nTrial/bestBlockSize) threadCount = nTrial/bestBlockSize;
+            SymFunEvaluationPlan plan(SymFunEvaluationPlan::THREADED,bestBlockSize,threadCount);
+            planTime = timePlan(F,&x[0],nTrial,&f[0],plan);
+            if(planTime < bestTime) {bestTime = planTime; bestPlan = plan;}
+        }
+
+        return bestPlan;
+    }
+
+    /**
+     Returns a hash of the compiled program of F. Instances whose compiled programs differ only
+     in the values of their numeric or symbolic constants have the same hash.
+    */
+
+    static unsigned long long getProgramHash(const SymFun& F)
+    {
+        unsigned long long hash = 14695981039346656037ULL;   // 64 bit FNV-1a
+
+        long header[3] = {F.variableCount, F.constantCount, F.symbolCount};
+        for(long i = 0; i < 3; i++)                    {hash = (hash ^ (unsigned long long)header[i])*1099511628211ULL;}
+        for(long i = 0; i < F.executionArraySize; i++) {hash = (hash ^ (unsigned long long)F.executionArray[i])*1099511628211ULL;}
+        return hash;
+    }
+
+    /**
+     Returns the CPU brand string, or "unknown" if it cannot be determined.
+    */
+
+    static std::string getCPUmodel()
+    {
+        unsigned int regs[12];
+        for(long i = 0; i < 12; i++) regs[i] = 0;
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int info[4];
+        __cpuid(info,0x80000000);
+        if((unsigned int)info[0] < 0x80000004) return std::string("unknown");
+        for(unsigned int j = 0; j < 3; j++)
+        {
+            __cpuid(info,0x80000002 + j);
+            for(long i = 0; i < 4; i++) regs[4*j+i] = (unsigned int)info[i];
+        }
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        if(__get_cpuid_max(0x80000000,0) < 0x80000004) return std::string("unknown");
+        for(unsigned int j = 0; j < 3; j++)
+        {
+            __get_cpuid(0x80000002 + j,&regs[4*j],&regs[4*j+1],&regs[4*j+2],&regs[4*j+3]);
+        }
+#else
+        return std::string("unknown");
+#endif
+
+        char brand[49];
+        std::memcpy(brand,regs,48);
+        brand[48] = '\0';
+
+        std::string model(brand);
+        size_t first = model.find_first_not_of(" ");
+        size_t last  = model.find_last_not_of(" ");
+        if(first == std::string::npos) return std::string("unknown");
+        return model.substr(first,last-first+1);
+    }
+
+protected:
+
+    template<class T>
+    double timePlan(const SymFun& F, const T* const* x, long n, T* f, const SymFunEvaluationPlan& plan) const
+    {
+        double bestTime = 0.0;
+        for(long r = 0; r < trialRepetitions; r++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            F.evaluateBatch(x,n,f,plan);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if((r == 0)||(elapsed.count() < bestTime)) bestTime = elapsed.count();
+        }
+        return bestTime;
+    }
+
+    static double getOperatorCost(const char* symbol)
+    {
+        if((!strcmp(symbol,"+"))||(!strcmp(symbol,"-"))||(!strcmp(symbol,"*"))
+        || (!strcmp(symbol,"abs"))||(!strcmp(symbol,"ceil"))||(!strcmp(symbol,"floor")))
+        {return 1.0;}
+
+        if((!strcmp(symbol,"/"))||(!strcmp(symbol,"sqrt")))
+        {return divideCost;}
+
+        if((!strcmp(symbol,"^"))||(!strcmp(symbol,"pow")))
+        {return 2.0*transcendentalCost;}
+
+        return transcendentalCost;
+    }
+
+    //
+    // Returns true if the operator has vector kernels (see SCC::RealBlockKernels).
+    //
+
+    static bool isVectorized(const char* symbol)
+    {
+        return (!strcmp(symbol,"+"))||(!strcmp(symbol,"-"))||(!strcmp(symbol,"*"))
+            || (!strcmp(symbol,"/"))||(!strcmp(symbol,"abs"))||(!strcmp(symbol,"sqrt"));
+    }
+
+    template<class T>
+    static const char* getValueTypeName()
+    {
+        return (sizeof(T) == sizeof(float)) ? "float" : "double";
+    }
+
+    template<class T>
+    std::string getTuningKey(const SymFun& F, long n) const
+    {
+        long sizeClass = 0;
+        while((n >> (sizeClass + 1)) > 0) {sizeClass++;}
+
+        std::ostringstream key;
+        key << std::hex << getProgramHash(F) << std::dec << " " << sizeClass << " "
+            << getValueTypeName<T>() << " " << RealOperatorLib::getInstructionSetLevel();
+        return key.str();
+    }
+
+    //
+    // Tuning file format : one plan per line
+    //
+    // [program hash] [size class] [value type] [instruction set level] [backend] [block size] [thread count] [CPU model]
+    //
+    // Only entries whose CPU model matches that of the current CPU are retained. Entries
+    // with a value type other than double or float (e.g. entries written in an earlier
+    // format) are ignored.
+    //
+
+    void loadTuningFile()
+    {
+        std::ifstream tuningFile(tuningFileName.c_str());
+        if(!tuningFile) return;
+
+        std::string cpuModel = getCPUmodel();
+        std::string line;
+
+        while(std::getline(tuningFile,line))
+        {
+            std::istringstream entry(line);
+            std::string hash; std::string valueType;
+            long sizeClass; long isaLevel; long backend; long blockSize; long threadCount;
+
+            if(!(entry >> hash >> sizeClass >> valueType >> isaLevel >> backend >> blockSize >> threadCount)) continue;
+            if((valueType != "double")&&(valueType != "float")) continue;
+
+            std::string model;
+            std::getline(entry,model);
+            size_t first = model.find_first_not_of(" \t");
+            model = (first == std::string::npos) ? std::string("") : model.substr(first);
+
+            if(model != cpuModel) continue;
+
+            std::ostringstream key;
+            key << hash << " " << sizeClass << " " << valueType << " " << isaLevel;
+            tunedPlans[key.str()] = SymFunEvaluationPlan(backend,blockSize,threadCount);
+        }
+    }
+
+    void appendTuningFile(const std::string& key, const SymFunEvaluationPlan& plan) const
+    {
+        std::ofstream tuningFile(tuningFileName.c_str(),std::ios::app);
+        if(!tuningFile) return;
+
+        tuningFile << key << " " << plan.backend << " " << plan.blockSize << " "
+                   << plan.threadCount << " " << getCPUmodel() << std::endl;
+    }
+
+    static constexpr long   minBlockSize       = 16;
+    static constexpr long   maxBlockSize       = 1024;
+    static constexpr long   l1CacheSize        = 32768;
+    static constexpr long   maxTrialSize       = 65536;
+    static constexpr long   trialRepetitions   = 3;
+
+    static constexpr double dispatchCost       = 6.0;
+    static constexpr double memoryCost         = 0.5;
+    static constexpr double divideCost         = 4.0;
+    static constexpr double transcendentalCost = 20.0;
+    static constexpr double threadStartCost    = 20000.0;
+
+    bool        autotuneFlag;
+    std::string tuningFileName;
+    bool        tuningFileLoaded;
+
+    std::map<std::string,SymFunEvaluationPlan> tunedPlans;
+    std::mutex planMutex;
+};
+}
+#endif
@@ -99,6 +99,12 @@ protected :
    friend class SymFun;
    friend class ExpressionTransform;
    friend class SymFunUtility;
+   template <long N> friend class SymFunN;
+   friend class SymFunCompiler;
+   friend class SymFunView;
+   friend class SymFunProgramBuilder;
+   friend class SymFunBinding;
+   friend class CompactSymFun;
 
     SymFunException () : std::runtime_error("SymFun error"),
     errorMessage("SymFun error"),errorInfo(""),offendingString("")
@@ -0,0 +1,228 @@
+//
+//##################################################################
+//                  SCC_SymFunMemoryResource.h
+//##################################################################
+//
+// The memory resource interface used to allocate the data of
+// SCC::SymFun instances, and an allocator that uses it.
+//
+// SCC::SymFunMemoryResource has the interface of std::pmr::memory_resource
+// and is the same class for all versions of C++, so translation units
+// compiled with different versions see the same type. With C++17 (and an
+// implementation that provides <memory_resource>) adapter classes allow a
+// std::pmr memory resource to be used as an SCC::SymFunMemoryResource, and
+// an SCC::SymFunMemoryResource to be used as a std::pmr memory resource.
+//
+// Chris Anderson (C) UCLA 2022
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <cstddef>
+
+#if (__cplusplus >= 201703L) && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define SCC_SYMFUN_PMR_
+#endif
+#endif
+
+#ifndef SYMFUN_MEMORY_RESOURCE_
+#define SYMFUN_MEMORY_RESOURCE_
+
+namespace SCC
+{
+
+/*!
+ \class SCC::SymFunMemoryResource
+ \brief A memory resource interface, the same as that of std::pmr::memory_resource
+
+ Derived classes implement do_allocate, do_deallocate and do_is_equal.
+
+ \headerfile SCC_SymFunMemoryResource.h "SCC_SymFunMemoryResource.h"
+*/
+
+class SymFunMemoryResource
+{
+public:
+
+    virtual ~SymFunMemoryResource() {}
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+    {
+        return do_allocate(bytes,alignment);
+    }
+
+    void deallocate(void* p, size_t bytes, size_t alignment = alignof(std::max_align_t))
+    {
+        do_deallocate(p,bytes,alignment);
+    }
+
+    bool is_equal(const SymFunMemoryResource& other) const noexcept
+    {
+        return do_is_equal(other);
+    }
+
+protected:
+
+    virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+    virtual void  do_deallocate(void* p, size_t bytes, size_t alignment) = 0;
+    virtual bool  do_is_equal(const SymFunMemoryResource& other) const noexcept = 0;
+};
+
+#ifdef SCC_SYMFUN_PMR_
+
+/*!
+ \class SCC::SymFunPMRadapter
+ \brief An SCC::SymFunMemoryResource that obtains its memory from a std::pmr::memory_resource
+
+ Sample:
+ \code
+    std::pmr::unsynchronized_pool_resource pool;
+    SCC::SymFunPMRadapter resource(&pool);
+
+    SCC::SymFun F(V,C,Cvalues,S,&resource);
+ \endcode
+
+ \headerfile SCC_SymFunMemoryResource.h "SCC_SymFunMemoryResource.h"
+*/
+
+class SymFunPMRadapter : public SymFunMemoryResource
+{
+public:
+
+    SymFunPMRadapter(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    : resource(resource) {}
+
+    std::pmr::memory_resource* getResource() const
+    {
+        return resource;
+    }
+
+protected:
+
+    void* do_allocate(size_t bytes, size_t alignment)
+    {
+        return resource->allocate(bytes,alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment)
+    {
+        resource->deallocate(p,bytes,alignment);
+    }
+
+    bool do_is_equal(const SymFunMemoryResource& other) const noexcept
+    {
+        const SymFunPMRadapter* A = dynamic_cast<const SymFunPMRadapter*>(&other);
+        return (A != 0) && resource->is_equal(*A->resource);
+    }
+
+    std::pmr::memory_resource* resource;
+};
+
+/*!
+ \class SCC::SymFunPMRresource
+ \brief A std::pmr::memory_resource that obtains its memory from an SCC::SymFunMemoryResource
+
+ Allows an SCC::SymFunMemoryResource, e.g. an SCC::SymFunArena, to be used as the memory resource
+ of std::pmr containers.
+
+ \headerfile SCC_SymFunMemoryResource.h "SCC_SymFunMemoryResource.h"
+*/
+
+class SymFunPMRresource : public std::pmr::memory_resource
+{
+public:
+
+    SymFunPMRresource(SymFunMemoryResource* resource) : resource(resource) {}
+
+    SymFunMemoryResource* getResource() const
+    {
+        return resource;
+    }
+
+protected:
+
+    void* do_allocate(size_t bytes, size_t alignment)
+    {
+        return resource->allocate(bytes,alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment)
+    {
+        resource->deallocate(p,bytes,alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept
+    {
+        const SymFunPMRresource* R = dynamic_cast<const SymFunPMRresource*>(&other);
+        return (R != 0) && resource->is_equal(*R->resource);
+    }
+
+    SymFunMemoryResource* resource;
+};
+
+#endif
+
+//
+//  An allocator that obtains memory from an SCC::SymFunMemoryResource. It is
+//  used to place the shared program data of an SCC::SymFun (with std::allocate_shared)
+//  in the memory resource.
+//
+
+template <class T>
+class SymFunAllocator
+{
+public:
+
+    typedef T value_type;
+
+    SymFunAllocator(SymFunMemoryResource* resource) : memoryResource(resource) {}
+
+    template <class U>
+    SymFunAllocator(const SymFunAllocator<U>& A) : memoryResource(A.memoryResource) {}
+
+    T* allocate(size_t n)
+    {
+        return (T*)memoryResource->allocate(n*sizeof(T),alignof(T));
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        memoryResource->deallocate(p,n*sizeof(T),alignof(T));
+    }
+
+    template <class U>
+    bool operator==(const SymFunAllocator<U>& A) const
+    {
+        return memoryResource == A.memoryResource;
+    }
+
+    template <class U>
+    bool operator!=(const SymFunAllocator<U>& A) const
+    {
+        return memoryResource != A.memoryResource;
+    }
+
+    SymFunMemoryResource* memoryResource;
+};
+
+}
+#endif
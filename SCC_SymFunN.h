@@ -0,0 +1,188 @@
+//
+//##################################################################
+//                     SCC_SymFunN.h
+//##################################################################
+//
+// A class for the evaluation of SCC::SymFun instances of N variables,
+// where N is specified at compile time.
+//
+// With C++20 (and an implementation that provides <span>) functions
+// may also be evaluated with std::span<const double,N> arguments.
+//
+// Chris Anderson (C) UCLA 2022
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <array>
+#include <string>
+#include <sstream>
+#include <utility>
+
+#if (__cplusplus >= 202002L) && defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#define SCC_SYMFUN_SPAN_
+#endif
+#endif
+
+#include "SCC_SymFun.h"
+#include "SCC_SymFunException.h"
+
+#ifndef SYMFUN_N_
+#define SYMFUN_N_
+
+namespace SCC
+{
+
+/*!
+ \class SCC::SymFunN
+ \brief A class for evaluating an SCC::SymFun of N variables, where N is a template parameter
+
+ An SCC::SymFunN<N> is constructed from an SCC::SymFun of N variables. The number of variables
+ is checked once, when the instance is constructed (an SCC::SymFunException is thrown if it is
+ not N), and the number of arguments of each evaluation is checked at compile time, so evaluation
+ involves no run time argument checks and no vector construction. The SCC::SymFunN<N> shares
+ the compiled program of the SCC::SymFun it is constructed from.
+
+ The arguments may be specified as N values, as a std::array<double,N> or, with C++20, as a
+ std::span<const double,N>.
+
+ As with SCC::SymFun, an instance should not be used for evaluation by more than one thread
+ at a time.
+
+ Sample:
+ \code
+    SCC::SymFun F({"x","y","z"},"x*y + z");
+    SCC::SymFunN<3> F3(F);
+
+    double f = F3(1.0,2.0,3.0);
+
+    std::array<double,3> x = {1.0,2.0,3.0};
+    double g = F3(x);
+ \endcode
+
+ \headerfile SCC_SymFunN.h "SCC_SymFunN.h"
+*/
+
+template <long N>
+class SymFunN
+{
+public:
+
+    /**
+     Creates an instance that evaluates F. Throws an SCC::SymFunException if the
+     number of variables of F is not N.
+    */
+
+    SymFunN(const SymFun& F) : F(F)
+    {
+        if(this->F.variableCount != N)
+        {
+            std::ostringstream errInfo;
+            errInfo << "SCC::SymFunN<" << N << "> constructed with a function of "
+                    << this->F.variableCount << " variables";
+            throw SymFunException("Incorrect number of variables",errInfo.str(),
+                                  this->F.getConstructorString());
+        }
+        if((this->F.evaluationData == 0)&&(this->F.program)) this->F.createEvaluationData();
+    }
+
+    // The evaluation data of an SCC::SymFun is created when first needed, so
+    // copies create it here rather than when evaluated.
+
+    SymFunN(const SymFunN& G) : F(G.F)
+    {
+        if((F.evaluationData == 0)&&(F.program)) F.createEvaluationData();
+    }
+
+    SymFunN(SymFunN&& G) noexcept : F(std::move(G.F))
+    {}
+
+    SymFunN& operator=(const SymFunN& G)
+    {
+        F = G.F;
+        if((F.evaluationData == 0)&&(F.program)) F.createEvaluationData();
+        return *this;
+    }
+
+    SymFunN& operator=(SymFunN&& G) noexcept
+    {
+        F = std::move(G.F);
+        return *this;
+    }
+
+    /**
+     Returns the value of the function at the N arguments. The number of
+     arguments is checked at compile time.
+    */
+
+    template<class... Args>
+    double operator()(Args... args) const
+    {
+        static_assert(sizeof...(Args) == N, "SCC::SymFunN : incorrect number of arguments");
+        const double x[sizeof...(Args) + 1] = {(double)args...};
+        return evaluate(x);
+    }
+
+    double operator()(const std::array<double,N>& x) const
+    {
+        return evaluate(x.data());
+    }
+
+#ifdef SCC_SYMFUN_SPAN_
+    double operator()(std::span<const double,N> x) const
+    {
+        return evaluate(x.data());
+    }
+#endif
+
+    /**
+     Returns the value of the function at the point x[0], ..., x[N-1].
+    */
+
+    double evaluate(const double* x) const
+    {
+        double* data = F.evaluationData;
+        for(long i = 0; i < N; i++) {data[i] = x[i];}
+        return F.evaluate();
+    }
+
+    void setConstantValue(const std::string& C, double x)
+    {
+        F.setConstantValue(C,x);
+    }
+
+    void setConstant(const SymFun::ConstantHandle& h, double x)
+    {
+        F.setConstant(h,x);
+    }
+
+    const SymFun& getSymFun() const
+    {
+        return F;
+    }
+
+protected:
+
+    SymFun F;
+};
+}
+#endif
@@ -0,0 +1,81 @@
+//
+//##################################################################
+//                  SCC_SymFunOutputMode.h
+//##################################################################
+//
+// A class whose instances specify how the results of the batch
+// evaluation member functions of SCC::SymFun are stored.
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+
+#ifndef SYMFUN_OUTPUT_MODE_
+#define SYMFUN_OUTPUT_MODE_
+
+namespace SCC
+{
+
+/*!
+ \class SCC::SymFunOutputMode
+ \brief A class whose instances specify how the function values of a batch evaluation are combined with the output array
+
+ With f(x_k) the function value at the kth point and y the output array, the operations are
+
+ OVERWRITE  : y[k]  = f(x_k)
+
+ ADD        : y[k] += f(x_k)
+
+ SCALED_ADD : y[k] += alpha*f(x_k)
+
+ MULTIPLY   : y[k] *= f(x_k)
+
+ The operation is applied as the values of each block are stored, so no temporary array,
+ and no second pass over the output, is required.
+
+ \headerfile SCC_SymFunOutputMode.h "SCC_SymFunOutputMode.h"
+*/
+
+class SymFunOutputMode
+{
+public:
+
+    enum {OVERWRITE = 0, ADD = 1, SCALED_ADD = 2, MULTIPLY = 3};
+
+    /**
+     Null constructor. Creates an instance that specifies OVERWRITE.
+    */
+    SymFunOutputMode()
+    {
+        operation = OVERWRITE;
+        alpha     = 1.0;
+    }
+
+    SymFunOutputMode(long operation, double alpha = 1.0)
+    {
+        this->operation = operation;
+        this->alpha     = alpha;
+    }
+
+    long   operation;
+    double alpha;      // the scale factor for SCALED_ADD
+};
+}
+#endif
@@ -0,0 +1,353 @@
+//
+//##################################################################
+//                     SCC_SymFunProgram.h
+//##################################################################
+//
+// A class whose instances hold the compiled program and symbol tables
+// of an SCC::SymFun. Instances are immutable once created and are
+// shared, through a reference counted pointer, by copies of an SCC::SymFun.
+//
+// Chris Anderson (C) UCLA 2022
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <cstring>
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SCC_RealOperatorLib.h"
+#include "SCC_ExpressionTransform.h"
+#include "SCC_SymFunMemoryResource.h"
+#include "SCC_SymFunSymbolTable.h"
+
+//
+// strcpy_s is not implemented as part of C++11 (arrgh) so this macro
+// inserts strcpy calls.
+//
+
+#ifdef _MSC_VER
+#define COPYSTR(dst,count,src) strcpy_s(dst,count,src)
+#else
+#define COPYSTR(dst,count,src) strcpy(dst,src)
+#endif
+
+#ifndef SYMFUN_PROGRAM_
+#define SYMFUN_PROGRAM_
+
+namespace SCC
+{
+class SymFunProgram
+{
+public:
+
+    SymFunProgram()
+    {
+        arena              = 0;
+        arenaSize          = 0;
+        memoryResource     = 0;
+
+        constructorString  = 0;
+
+        variableNames      = 0;
+        variableIds        = 0;
+        variableCount      = 0;
+
+        constantNames      = 0;
+        constantIds        = 0;
+        constantCount      = 0;
+        constantValues     = 0;
+        constantTable      = 0;
+        constantTableSize  = 0;
+
+        symbolCount        = 0;
+        sNames             = 0;
+        symbolIds          = 0;
+
+        executionArray     = 0;
+        executionArraySize = 0;
+
+        initialData        = 0;
+        evaluationDataSize = 0;
+    }
+
+    ~SymFunProgram()
+    {
+        if(arena == 0) return;
+        if(memoryResource != 0) {memoryResource->deallocate(arena, arenaSize, arenaAlignment);}
+        else                    {delete [] arena;}
+    }
+
+    //
+    // Compiles the expression S in the variables V and symbolic constants C
+    // whose initial values are Cvalues.
+    //
+    // The names of the variables and constants are interned in the
+    // SCC::SymFunSymbolTable; the program stores their ids and pointers to the
+    // interned names. The names of the numeric literals are not interned (the
+    // number of distinct literals is unbounded); they are stored in the program
+    // and their ids are -1.
+    //
+    // The program, the initial evaluation data (the literal pool), the initial
+    // values of the constants, the symbol ids and name pointers, the literal
+    // names and the constructor string are stored in a single allocation, the
+    // arena, with the layout
+    //
+    // [initialData][constantValues][executionArray][symbol ids][constant table][name pointers][literal names][constructor string]
+    //
+    // The constant table is an open addressed hash table mapping the id of
+    // a constant name to its index.
+    //
+    // The arena start is aligned to arenaAlignment (a cache line) and each
+    // section starts at a multiple of sectionAlignment.
+    //
+    // If resource is non-null the arena is allocated from it, otherwise
+    // with new.
+    //
+    // Returns 0 (= no error) or 1 (= error). Syntax errors in S generate
+    // an SCC::SymFunException.
+    //
+
+    long create(const char* const* V, long Vcount, const char* const* C,  long Ccount, double const* Cvalues, char const* S,
+                SymFunMemoryResource* resource = 0)
+    {
+        long i;
+
+        // The names are copied to arrays of char* as required by ExpressionTransform
+
+        std::vector<std::string> Vnames(V, V + Vcount);
+        std::vector<std::string> Cnames(C, C + Ccount);
+        std::vector<char*> Vptr(Vcount + 1);
+        std::vector<char*> Cptr(Ccount + 1);
+        for(i = 0; i < Vcount; i++) {Vptr[i] = &Vnames[i][0];}
+        for(i = 0; i < Ccount; i++) {Cptr[i] = &Cnames[i][0];}
+        std::string Sstring(S);
+
+        RealOperatorLib     L;
+        ExpressionTransform T;
+
+        long expReturn;
+
+        expReturn =  T.initialize(&Vptr[0], Vcount, &Cptr[0], Ccount, &Sstring[0], &L);
+        if(expReturn != 0) {return 1;}
+
+        return create(T.getSymbolNamesPtr(), T.getSymbolCount(), Vcount, Ccount, Cvalues,
+                      T.getExecutionArrayPtr(), T.getExecutionArraySize(), T.getEvaluationDataSize(),
+                      S, resource);
+    }
+
+    //
+    // Creates the program from its components, e.g. a program assembled by an
+    // SCC::SymFunProgramBuilder rather than compiled from an expression.
+    //
+    // symbolNames[0], ..., symbolNames[Vcount-1] are the variable names, the next Ccount
+    // names are the names of the symbolic constants whose initial values are Cvalues,
+    // and the remaining names (up to symbolCount) are the numeric constants. The result
+    // of the program is in data slot evaluationDataSize-1. S is the constructor string.
+    //
+
+    long create(char const* const* symbolNames, long symbolCount, long Vcount, long Ccount, double const* Cvalues,
+                long const* programArray, long programSize, long evaluationDataSize, char const* S,
+                SymFunMemoryResource* resource = 0)
+    {
+        long i;
+        long j;
+
+        this->variableCount      = Vcount;
+        this->constantCount      = Ccount;
+        this->evaluationDataSize = evaluationDataSize;
+        this->executionArraySize = programSize;
+        this->symbolCount        = symbolCount;
+    //
+    //  Determine the arena layout
+    //
+        size_t initialDataOffset    = 0;
+        size_t constantValuesOffset = initialDataOffset    + alignSize(evaluationDataSize*sizeof(double));
+        size_t executionArrayOffset = constantValuesOffset + alignSize(Ccount*sizeof(double));
+        size_t symbolIdOffset       = executionArrayOffset + alignSize(executionArraySize*sizeof(long));
+        constantTableSize = 0;
+        if(Ccount > 0) {constantTableSize = 2; while(constantTableSize < 2*Ccount) {constantTableSize *= 2;}}
+
+        size_t constantTableOffset  = symbolIdOffset       + alignSize(symbolCount*sizeof(long));
+        size_t literalNameSize = 0;
+        for(i = Vcount + Ccount; i < symbolCount; i++) {literalNameSize += strlen(symbolNames[i]) + 1;}
+
+        size_t namePointerOffset    = constantTableOffset  + alignSize(constantTableSize*sizeof(long));
+        size_t literalNameOffset    = namePointerOffset    + alignSize(symbolCount*sizeof(char*));
+        size_t stringOffset         = literalNameOffset    + alignSize(literalNameSize);
+        arenaSize                   = stringOffset         + alignSize(strlen(S) + 1);
+
+        char* base;
+        memoryResource = resource;
+
+        if(memoryResource != 0)
+        {
+        arena = (char*)memoryResource->allocate(arenaSize, arenaAlignment);
+        base  = arena;
+        }
+        else
+        {
+        arena = new char[arenaSize + arenaAlignment];
+        base  = arena + (arenaAlignment - (size_t)((std::uintptr_t)arena % arenaAlignment)) % arenaAlignment;
+        }
+
+        initialData    = (double*)(base + initialDataOffset);
+        constantValues = (Ccount > 0) ? (double*)(base + constantValuesOffset) : 0;
+        executionArray = (long*)(base + executionArrayOffset);
+
+        symbolIds         = (symbolCount > 0) ? (long*)(base + symbolIdOffset) : 0;
+        constructorString = base + stringOffset;
+        COPYSTR(constructorString, strlen(S) + 1, S);
+    //
+    //  Intern the variable and constant names and copy the literal names. The
+    //  symbols are ordered variables, symbolic constants, numeric constants, so
+    //  the variable and constant names and ids are leading sections of sNames
+    //  and symbolIds.
+    //
+        const char** names       = (symbolCount > 0) ? (const char**)(base + namePointerOffset) : 0;
+        char*        literalName = base + literalNameOffset;
+
+        for(i = 0; i < Vcount + Ccount; i++)
+        {
+        symbolIds[i] = SymFunSymbolTable::getSymbolId(symbolNames[i]);
+        names[i]     = SymFunSymbolTable::getSymbolName(symbolIds[i]);
+        }
+
+        for(i = Vcount + Ccount; i < symbolCount; i++)
+        {
+        symbolIds[i] = -1;
+        names[i]     = literalName;
+        COPYSTR(literalName, strlen(symbolNames[i]) + 1, symbolNames[i]);
+        literalName += strlen(symbolNames[i]) + 1;
+        }
+
+        sNames = names;
+
+        variableNames = (Vcount > 0) ? sNames             : 0;
+        variableIds   = (Vcount > 0) ? symbolIds          : 0;
+        constantNames = (Ccount > 0) ? sNames + Vcount    : 0;
+        constantIds   = (Ccount > 0) ? symbolIds + Vcount : 0;
+    //
+    //  Build the constant table; entries are constant index + 1, 0 if empty.
+    //
+        constantTable = (constantTableSize > 0) ? (long*)(base + constantTableOffset) : 0;
+
+        for(i = 0; i < constantTableSize; i++) {constantTable[i] = 0;}
+
+        for(i = 0; i < Ccount; i++)
+        {
+        j = constantIds[i] & (constantTableSize - 1);
+        while((constantTable[j] != 0)&&(constantIds[constantTable[j]-1] != constantIds[i]))
+        {j = (j + 1) & (constantTableSize - 1);}
+        if(constantTable[j] == 0) constantTable[j] = i + 1;
+        }
+    //
+    //  Copy the program
+    //
+        for(i = 0; i < executionArraySize; i++)
+        {executionArray[i] = programArray[i];}
+    //
+    //  Initial evaluation data : variables are set to 0, symbolic constants to
+    //  their initial values and numeric constants to their values.
+    //
+        for(i = 0; i < Ccount; i++)
+        {constantValues[i] = Cvalues[i];}
+
+        for(i = 0; i < evaluationDataSize; i++)
+        {initialData[i] = 0.0;}
+
+        for(i = variableCount,j = 0; i < variableCount + constantCount; i++,j++)
+        {initialData[i] = constantValues[j];}
+
+        for(i = variableCount + constantCount; i < symbolCount; i++)
+        {initialData[i] = atof(sNames[i]);}
+
+        return 0;
+    }
+
+    //
+    // Returns the index of the symbolic constant whose name has the
+    // symbol table id nameId, or -1 if there is no such constant.
+    //
+
+    long getConstantIndex(long nameId) const
+    {
+        if((constantTableSize == 0)||(nameId < 0)) return -1;
+
+        long j = nameId & (constantTableSize - 1);
+        while(constantTable[j] != 0)
+        {
+        if(constantIds[constantTable[j]-1] == nameId) return constantTable[j] - 1;
+        j = (j + 1) & (constantTableSize - 1);
+        }
+        return -1;
+    }
+
+    enum {arenaAlignment = 64, sectionAlignment = 8};
+
+    char*       arena;              // the single allocation holding the data below
+    size_t      arenaSize;
+
+    SymFunMemoryResource* memoryResource;   // source of the arena (0 = new)
+
+    char*       constructorString;
+
+    const char* const* variableNames;   // names and ids of interned symbols
+    long*       variableIds;
+    long        variableCount;
+
+    const char* const* constantNames;
+    long*       constantIds;
+    long        constantCount;
+    double*     constantValues;     // initial values of the symbolic constants
+
+    long*       constantTable;      // constant name id -> index + 1
+    long        constantTableSize;  // a power of 2
+
+    long        symbolCount;        // total number of variables, symbolic constants,
+                                    // and numeric constants
+    const char* const* sNames;      // names of all symbols; literal names are not interned
+    long*       symbolIds;          // literal ids are -1
+
+    long*       executionArray;
+    long        executionArraySize;
+
+    double*     initialData;        // initial evaluation data
+    long        evaluationDataSize;
+
+private:
+
+    static size_t alignSize(size_t n)
+    {
+        return ((n + sectionAlignment - 1)/sectionAlignment)*sectionAlignment;
+    }
+
+private:
+
+    // Instances are shared, not copied
+
+    SymFunProgram(const SymFunProgram&);
+    SymFunProgram& operator=(const SymFunProgram&);
+};
+}
+#endif
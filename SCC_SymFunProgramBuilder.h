@@ -0,0 +1,339 @@
+//
+//##################################################################
+//                  SCC_SymFunProgramBuilder.h
+//##################################################################
+//
+// A class for assembling an SCC::SymFunProgram from the programs of
+// other SCC::SymFun instances, without re-parsing expressions.
+// Identical operations are created once (common subexpression
+// elimination), so shared subexpressions are evaluated once.
+//
+// Chris Anderson (C) UCLA 2022
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "SCC_SymFunProgram.h"
+#include "SCC_SymFunSymbolTable.h"
+#include "SCC_SymFunMemoryResource.h"
+#include "SCC_SymFunException.h"
+
+#ifndef SYMFUN_PROGRAM_BUILDER_
+#define SYMFUN_PROGRAM_BUILDER_
+
+namespace SCC
+{
+//
+// Operations are added in the order in which they are to be executed. The
+// operands of operations are specified by the values returned by addVariable,
+// addConstant, addLiteral, addOperation and addProgram. An operand encodes
+// its kind (variable, symbolic constant, numeric constant or temporary) in its
+// low two bits and the index within its kind in the remaining bits; the data
+// slots of the operands are determined when the program is created, since the
+// slots of the temporaries follow those of all of the constants.
+//
+// Variables and symbolic constants are identified by name, and numeric constants
+// by value, so each appears once in the program created. A name cannot be both a
+// variable and a symbolic constant; adding a variable with the name of a constant,
+// or a constant with the name of a variable, generates an SCC::SymFunException.
+// An operation with the
+// same function index and operands as an existing operation is not added; the
+// operand of the existing result is returned. The operations are pure and each
+// writes a distinct temporary, so this does not change the values computed.
+//
+class SymFunProgramBuilder
+{
+public:
+
+    enum {VARIABLE = 0, CONSTANT = 1, LITERAL = 2, TEMPORARY = 3};
+
+    SymFunProgramBuilder()
+    {
+        temporaryCount = 0;
+    }
+
+    //
+    // Returns the operand of the variable named V, adding the variable if required.
+    // An SCC::SymFunException is generated if V is the name of a symbolic constant.
+    //
+
+    long addVariable(const std::string& V)
+    {
+        long id = SymFunSymbolTable::getSymbolId(V);
+        std::map<long,long>::iterator it = variableIndex.find(id);
+        if(it != variableIndex.end()) return createOperand(it->second,VARIABLE);
+
+        if(constantIndex.find(id) != constantIndex.end()) nameError(V);
+
+        long i = (long)variableNames.size();
+        variableIndex[id] = i;
+        variableNames.push_back(V);
+        return createOperand(i,VARIABLE);
+    }
+
+    //
+    // Returns the operand of the symbolic constant named C, adding the constant
+    // with initial value x if required. If the constant exists its value is not changed.
+    // An SCC::SymFunException is generated if C is the name of a variable.
+    //
+
+    long addConstant(const std::string& C, double x)
+    {
+        long id = SymFunSymbolTable::getSymbolId(C);
+        std::map<long,long>::iterator it = constantIndex.find(id);
+        if(it != constantIndex.end()) return createOperand(it->second,CONSTANT);
+
+        if(variableIndex.find(id) != variableIndex.end()) nameError(C);
+
+        long i = (long)constantNames.size();
+        constantIndex[id] = i;
+        constantNames.push_back(C);
+        constantValues.push_back(x);
+        return createOperand(i,CONSTANT);
+    }
+
+    //
+    // Returns the operand of the numeric constant L (e.g. "2.0"), adding the
+    // constant if there is no numeric constant with the same value.
+    //
+
+    long addLiteral(const std::string& L)
+    {
+        double x = atof(L.c_str());
+        std::map<double,long>::iterator it = literalIndex.find(x);
+        if(it != literalIndex.end()) return createOperand(it->second,LITERAL);
+
+        long i = (long)literalNames.size();
+        literalIndex[x] = i;
+        literalNames.push_back(L);
+        return createOperand(i,LITERAL);
+    }
+
+    //
+    // Adds the operation with function index functionIndex (an index of the
+    // SCC::RealOperatorLib operators) applied to the operands args[0], ..., args[argCount-1]
+    // and returns the operand of its result. Operations with the unary + operator
+    // are not added.
+    //
+
+    long addOperation(long functionIndex, const long* args, long argCount)
+    {
+        // The unary + operator is the identity
+
+        if((functionIndex == 0)&&(argCount == 1)) return args[0];
+
+        std::vector<long> key(argCount + 1);
+        key[0] = functionIndex;
+        for(long j = 0; j < argCount; j++) {key[j+1] = args[j];}
+
+        std::map<std::vector<long>,long>::iterator it = operationIndex.find(key);
+        if(it != operationIndex.end()) return it->second;
+
+        long result = createOperand(temporaryCount,TEMPORARY);
+        temporaryCount++;
+
+        operations.push_back(functionIndex);
+        operations.push_back(argCount + 1);
+        for(long j = 0; j < argCount; j++) {operations.push_back(args[j]);}
+        operations.push_back(result);
+
+        operationIndex[key] = result;
+        return result;
+    }
+
+    //
+    // Adds the operations of the program P and returns the operand of its result.
+    //
+    // If variableOperands is non-null the ith variable of P is replaced by the operand
+    // variableOperands[i]; otherwise variables are identified by name. Symbolic
+    // constants are identified by name; constants that are added take their initial
+    // values from Cvalues, or from P if Cvalues is null.
+    //
+
+    long addProgram(const SymFunProgram& P, const long* variableOperands = 0, const double* Cvalues = 0)
+    {
+        long i;
+        std::vector<long> operand(P.evaluationDataSize,-1);
+
+        for(i = 0; i < P.variableCount; i++)
+        {
+        operand[i] = (variableOperands != 0) ? variableOperands[i] : addVariable(P.sNames[i]);
+        }
+
+        for(i = 0; i < P.constantCount; i++)
+        {
+        operand[P.variableCount + i] = addConstant(P.constantNames[i], (Cvalues != 0) ? Cvalues[i] : P.constantValues[i]);
+        }
+
+        for(i = P.variableCount + P.constantCount; i < P.symbolCount; i++)
+        {
+        operand[i] = addLiteral(P.sNames[i]);
+        }
+
+        const long* program = P.executionArray;
+        long executionIndex = 0;
+        long functionIndex;
+        long argCount;
+        long args[10];   // limit of 10 args for now
+
+        while(executionIndex < P.executionArraySize)
+        {
+        functionIndex = program[executionIndex]; executionIndex++;
+        argCount      = program[executionIndex]; executionIndex++;
+        for(long j = 0; j < argCount - 1; j++) {args[j] = operand[program[executionIndex + j]];}
+        operand[program[executionIndex + argCount - 1]] = addOperation(functionIndex,args,argCount - 1);
+        executionIndex += argCount;
+        }
+
+        return operand[P.evaluationDataSize - 1];
+    }
+
+    //
+    // Returns the number of operations added.
+    //
+
+    long getOperationCount() const
+    {
+        return temporaryCount;
+    }
+
+    //
+    // Creates in P the program whose result is the value of operand result. The
+    // constructor string of the program is S.
+    //
+    // Returns 0 (= no error) or 1 (= error).
+    //
+
+    long create(SymFunProgram& P, long result, const std::string& S, SymFunMemoryResource* resource = 0)
+    {
+        std::vector<long> outputSlots;
+        return create(P, &result, 1, outputSlots, S, resource);
+    }
+
+    //
+    // Creates in P the program that computes the values of the operands outputs[0], ...,
+    // outputs[outputCount-1]. On return outputSlots[j] is the data slot of the jth
+    // output. The value of the last output is also in slot evaluationDataSize-1, so
+    // the program evaluates to it when used as the program of an SCC::SymFun. The
+    // constructor string of the program is S.
+    //
+    // Returns 0 (= no error) or 1 (= error).
+    //
+
+    long create(SymFunProgram& P, const long* outputs, long outputCount, std::vector<long>& outputSlots,
+                const std::string& S, SymFunMemoryResource* resource = 0)
+    {
+        long i;
+
+        long Vcount      = (long)variableNames.size();
+        long Ccount      = (long)constantNames.size();
+        long symbolCount = Vcount + Ccount + (long)literalNames.size();
+
+        std::vector<const char*> symbolNames(symbolCount + 1);
+        for(i = 0; i < Vcount; i++)                       {symbolNames[i] = variableNames[i].c_str();}
+        for(i = 0; i < Ccount; i++)                       {symbolNames[Vcount + i] = constantNames[i].c_str();}
+        for(i = 0; i < (long)literalNames.size(); i++)    {symbolNames[Vcount + Ccount + i] = literalNames[i].c_str();}
+
+        std::vector<long> program(operations.size());
+        long executionIndex = 0;
+        long argCount;
+
+        while(executionIndex < (long)operations.size())
+        {
+        program[executionIndex] = operations[executionIndex]; executionIndex++;
+        argCount                = operations[executionIndex];
+        program[executionIndex] = argCount;                   executionIndex++;
+        for(long j = 0; j < argCount; j++)
+        {
+        program[executionIndex] = getSlot(operations[executionIndex],Vcount,Ccount,symbolCount);
+        executionIndex++;
+        }
+        }
+
+        long evaluationDataSize = symbolCount + temporaryCount;
+
+        outputSlots.resize(outputCount);
+        for(i = 0; i < outputCount; i++) {outputSlots[i] = getSlot(outputs[i],Vcount,Ccount,symbolCount);}
+
+        // Copy the last output to a new last slot if required, using the unary + operator
+
+        if((outputCount > 0)&&(outputSlots[outputCount-1] != evaluationDataSize - 1))
+        {
+        program.push_back(0);
+        program.push_back(2);
+        program.push_back(outputSlots[outputCount-1]);
+        program.push_back(evaluationDataSize);
+        evaluationDataSize++;
+        }
+
+        const double* Cvalues = (Ccount > 0) ? &constantValues[0] : 0;
+        const long*   programArray = program.empty() ? 0 : &program[0];
+
+        return P.create(&symbolNames[0], symbolCount, Vcount, Ccount, Cvalues,
+                        programArray, (long)program.size(), evaluationDataSize, S.c_str(), resource);
+    }
+
+protected:
+
+    static void nameError(const std::string& name)
+    {
+        throw SymFunException("Variable and symbolic constant with the same name",
+                              "The name " + name + " is a variable of one function and a symbolic constant of another","");
+    }
+
+    static long createOperand(long index, long kind)
+    {
+        return 4*index + kind;
+    }
+
+    static long getSlot(long operand, long Vcount, long Ccount, long symbolCount)
+    {
+        long index = operand/4;
+        switch(operand % 4)
+        {
+        case VARIABLE : return index;
+        case CONSTANT : return Vcount + index;
+        case LITERAL  : return Vcount + Ccount + index;
+        default       : return symbolCount + index;
+        }
+    }
+
+    std::vector<std::string>  variableNames;
+    std::map<long,long>       variableIndex;      // name id -> variable index
+
+    std::vector<std::string>  constantNames;
+    std::vector<double>       constantValues;
+    std::map<long,long>       constantIndex;      // name id -> constant index
+
+    std::vector<std::string>  literalNames;
+    std::map<double,long>     literalIndex;       // value -> literal index
+
+    std::vector<long>         operations;         // program with operands in place of data slots
+    long                      temporaryCount;
+
+    std::map<std::vector<long>,long> operationIndex;   // (function index, args) -> result operand
+};
+}
+#endif
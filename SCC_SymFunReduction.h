@@ -0,0 +1,135 @@
+//
+//##################################################################
+//                  SCC_SymFunReduction.h
+//##################################################################
+//
+// A class whose instances hold the reductions (sum, sum of squares,
+// minimum and maximum) of the values of an SCC::SymFun over a batch
+// of points.
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <limits>
+
+#ifndef SYMFUN_REDUCTION_
+#define SYMFUN_REDUCTION_
+
+namespace SCC
+{
+
+/*!
+ \class SCC::SymFunReduction
+ \brief A class whose instances hold reductions of the values of an SCC::SymFun over a batch of points
+
+ Instances are returned by SCC::SymFun::evaluateReduction(...). With f_k the function value at the
+ kth point of the batch,
+
+ count        : the number of points
+
+ sum          : sum of f_k
+
+ sumOfSquares : sum of f_k^2
+
+ min, argMin  : the minimum of f_k and the smallest index k at which it occurs
+
+ max, argMax  : the maximum of f_k and the smallest index k at which it occurs
+
+ Sums are accumulated in double precision. For an empty batch min is +infinity, max is -infinity
+ and argMin and argMax are -1.
+
+ \headerfile SCC_SymFunReduction.h "SCC_SymFunReduction.h"
+*/
+
+class SymFunReduction
+{
+public:
+
+    SymFunReduction()
+    {
+        count        = 0;
+        sum          = 0.0;
+        sumOfSquares = 0.0;
+        min          =  std::numeric_limits<double>::infinity();
+        max          = -std::numeric_limits<double>::infinity();
+        argMin       = -1;
+        argMax       = -1;
+    }
+
+    /**
+     Accumulates the values f[0], ... ,f[m-1] at the points k, ... ,k+m-1.
+    */
+
+    template<class T>
+    void accumulate(const T* f, long k, long m)
+    {
+        double s   = 0.0;
+        double s2  = 0.0;
+        double fMin = min;
+        double fMax = max;
+        long   iMin = argMin;
+        long   iMax = argMax;
+        double v;
+
+        for(long q = 0; q < m; q++)
+        {
+            v   = (double)f[q];
+            s  += v;
+            s2 += v*v;
+            if((v < fMin)||(iMin < 0)) {fMin = v; iMin = k + q;}
+            if((v > fMax)||(iMax < 0)) {fMax = v; iMax = k + q;}
+        }
+
+        count        += m;
+        sum          += s;
+        sumOfSquares += s2;
+        min = fMin; argMin = iMin;
+        max = fMax; argMax = iMax;
+    }
+
+    /**
+     Combines the reductions of R with those of *this. Ties in the minimum or maximum are
+     resolved in favor of the smaller index, so the result does not depend on the order in which
+     minima and maxima are combined.
+    */
+
+    void combine(const SymFunReduction& R)
+    {
+        count        += R.count;
+        sum          += R.sum;
+        sumOfSquares += R.sumOfSquares;
+
+        if((R.argMin >= 0)&&((R.min < min)||((R.min == min)&&((argMin < 0)||(R.argMin < argMin)))))
+        {min = R.min; argMin = R.argMin;}
+
+        if((R.argMax >= 0)&&((R.max > max)||((R.max == max)&&((argMax < 0)||(R.argMax < argMax)))))
+        {max = R.max; argMax = R.argMax;}
+    }
+
+    long   count;
+    double sum;
+    double sumOfSquares;
+    double min;
+    double max;
+    long   argMin;
+    long   argMax;
+};
+}
+#endif
@@ -0,0 +1,343 @@
+//
+//##################################################################
+//                     SCC_SymFunSet.h
+//##################################################################
+//
+// A class for the evaluation of a set of functions of the same
+// variables that are compiled into a single program, so that the
+// subexpressions common to the functions are evaluated once.
+//
+// Chris Anderson (C) UCLA 2022
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <vector>
+#include <string>
+
+#include "SCC_SymFun.h"
+#include "SCC_SymFunProgramBuilder.h"
+#include "SCC_SymFunEvaluationPlan.h"
+
+#ifndef SYMFUN_SET_
+#define SYMFUN_SET_
+
+namespace SCC
+{
+
+/*!
+ \class SCC::SymFunSet
+ \brief A class for evaluating a set of functions of the same variables with a single fused program
+
+ An SCC::SymFunSet is created from the specifications of m functions of the same variables and symbolic
+ constants, or from m SCC::SymFun instances. The programs of the functions are merged into a single
+ program in which identical operations are carried out once, so that subexpressions common to
+ the functions (e.g. the entries of a stress tensor) are evaluated once per point rather than once
+ per function. Evaluation returns the values of all of the functions at each point.
+
+ When created from SCC::SymFun instances, the variables are those of the first instance
+ followed by any additional variables of the others, in order of appearance; symbolic constants
+ with the same name are the same constant and take the value of the first instance in which they occur.
+ An SCC::SymFunException is generated if a name is a variable of one instance and a symbolic constant
+ of another.
+
+ As with SCC::SymFun, evaluate(...) and the evaluation operators use the evaluation data of the
+ instance, so an instance should not be used for evaluation by more than one thread at a time;
+ evaluateBatch(...) does not modify the instance and may be invoked concurrently.
+
+ Sample:
+ \code
+    std::vector<std::string> V = {"x","y"};
+    std::vector<std::string> S = {"exp(-x*y)*x", "exp(-x*y)*y", "exp(-x*y)"};
+
+    SCC::SymFunSet F(V,S);
+
+    double f[3];
+    double x[] = {1.0,2.0};
+    F.evaluate(x,f);                   // f[j] = value of the jth function at (1,2)
+
+    double* Fvalues[] = {&f0[0],&f1[0],&f2[0]};
+    const double* X[] = {&xv[0],&yv[0]};
+    F.evaluateBatch(X,n,Fvalues);      // Fvalues[j][k] = value of the jth function at point k
+ \endcode
+
+ \headerfile SCC_SymFunSet.h "SCC_SymFunSet.h"
+*/
+
+class SymFunSet
+{
+public:
+
+    /**
+      Null constructor. The instance created must be initialized with
+      one of the initialize(...) member functions.
+    */
+
+    SymFunSet() : operationCount(0) {}
+
+    /**
+      Creates an instance for the functions specified by the elements of S
+      in the variables V. Syntax errors generate an SCC::SymFunException.
+    */
+
+    SymFunSet(const std::vector<std::string>& V, const std::vector<std::string>& S) : operationCount(0)
+    {
+        initialize(V,S);
+    }
+
+    /**
+      Creates an instance for the functions specified by the elements of S in the variables V
+      and the symbolic constants C whose initial values are Cvalues. Syntax errors generate
+      an SCC::SymFunException.
+    */
+
+    SymFunSet(const std::vector<std::string>& V, const std::vector<std::string>& C,
+              const std::vector<double>& Cvalues, const std::vector<std::string>& S) : operationCount(0)
+    {
+        initialize(V,C,Cvalues,S);
+    }
+
+    /**
+      Creates an instance for the functions F[0], ..., F[m-1]. The values of the symbolic
+      constants of the instances are used as initial values.
+    */
+
+    SymFunSet(const std::vector<SymFun>& F) : operationCount(0)
+    {
+        initialize(F);
+    }
+
+    long initialize(const std::vector<std::string>& V, const std::vector<std::string>& S)
+    {
+        return initialize(V,std::vector<std::string>(),std::vector<double>(),S);
+    }
+
+    long initialize(const std::vector<std::string>& V, const std::vector<std::string>& C,
+                    const std::vector<double>& Cvalues, const std::vector<std::string>& S)
+    {
+        std::vector<SymFun> Fset(S.size());
+        for(size_t j = 0; j < S.size(); j++)
+        {
+            long iReturn = C.empty() ? Fset[j].initialize(V,S[j]) : Fset[j].initialize(V,C,Cvalues,S[j]);
+            if(iReturn != 0) {F.initialize(); outputSlots.clear(); return 1;}
+        }
+        return createProgram(V,C,Fset);
+    }
+
+    long initialize(const std::vector<SymFun>& Fset)
+    {
+        return createProgram(std::vector<std::string>(),std::vector<std::string>(),Fset);
+    }
+
+    /**
+      Returns the number of functions.
+    */
+
+    long getFunctionCount() const
+    {
+        return (long)outputSlots.size();
+    }
+
+    /**
+      Returns the number of operations of the fused program, a measure of the
+      cost of evaluating all of the functions at a point.
+    */
+
+    long getOperationCount() const
+    {
+        return operationCount;
+    }
+
+    long getVariableCount() const
+    {
+        return F.getVariableCount();
+    }
+
+    std::vector<std::string> getVariableNames() const
+    {
+        return F.getVariableNames();
+    }
+
+    long getConstantCount() const
+    {
+        return F.getConstantCount();
+    }
+
+    std::vector<std::string> getConstantNames() const
+    {
+        return F.getConstantNames();
+    }
+
+    /**
+      Returns the std::string that specifies the jth function.
+    */
+
+    std::string getFunctionString(long j) const
+    {
+        return functionStrings[j];
+    }
+
+    /**
+     Evaluates the functions at the point x[0], ..., x[V-1], where V is the number of
+     variables. The value of the jth function is returned in f[j].
+    */
+
+    void evaluate(const double* x, double* f) const
+    {
+        if(F.evaluationData == 0) F.createEvaluationData();
+
+        double* data = F.evaluationData;
+        for(long i = 0; i < F.variableCount; i++) {data[i] = x[i];}
+        F.evaluate();
+
+        for(size_t j = 0; j < outputSlots.size(); j++) {f[j] = data[outputSlots[j]];}
+    }
+
+    /**
+     Returns the values of the functions at the point x.
+    */
+
+    std::vector<double> operator()(const std::vector<double>& x) const
+    {
+        std::vector<double> f(outputSlots.size());
+        if(!f.empty()) evaluate(x.empty() ? 0 : &x[0],&f[0]);
+        return f;
+    }
+
+    /**
+     Evaluates the functions at n points. The values of the ith variable are specified in
+     the array x[i], and the value of the jth function at the kth point is returned in f[j][k].
+     The value type T may be double or float (see SCC::SymFun::evaluateBatch).
+    */
+
+    template<class T>
+    void evaluateBatch(const T* const* x, long n, T* const* f) const
+    {
+        evaluateBatch(x,n,f,SymFunEvaluationPlan());
+    }
+
+    /**
+     Evaluates the functions at n points using the backend, block size and thread count
+     specified by plan.
+    */
+
+    template<class T>
+    void evaluateBatch(const T* const* x, long n, T* const* f, const SymFunEvaluationPlan& plan) const
+    {
+        if((n <= 0)||(outputSlots.empty())) return;
+
+        std::vector<double> data(F.evaluationDataSize);
+        F.initializeEvaluationData(&data[0]);
+
+        SymFun::BatchArrays<T> A(x,F.variableCount,f[0]);
+        A.outputArrays = f;
+        A.outputSlots  = &outputSlots[0];
+        A.outputCount  = (long)outputSlots.size();
+
+        F.evaluatePlan(A,&data[0],1,n,plan);
+    }
+
+    void setConstantValue(const std::string& C, double x)
+    {
+        F.setConstantValue(C,x);
+    }
+
+    double getConstantValue(const std::string& C) const
+    {
+        return F.getConstantValue(C);
+    }
+
+    SymFun::ConstantHandle getConstantHandle(const std::string& C) const
+    {
+        return F.getConstantHandle(C);
+    }
+
+    void setConstant(const SymFun::ConstantHandle& h, double x)
+    {
+        F.setConstant(h,x);
+    }
+
+    /**
+      Returns the SCC::SymFun whose program is the fused program; it
+      evaluates to the value of the last function.
+    */
+
+    const SymFun& getSymFun() const
+    {
+        return F;
+    }
+
+protected:
+
+    //
+    // Merges the programs of the functions Fset. The variables V and constants C
+    // (with the values of the first function) are added first, so they precede
+    // any other variables and constants of the functions.
+    //
+    // The names of the variables and constants of all of the functions are added
+    // before any program, in the order in which addProgram would add them, so that
+    // a name that is a variable of one function and a constant of another generates
+    // an SCC::SymFunException before the instance is modified.
+    //
+
+    long createProgram(const std::vector<std::string>& V, const std::vector<std::string>& C,
+                       const std::vector<SymFun>& Fset)
+    {
+        SymFunProgramBuilder B;
+
+        for(size_t i = 0; i < V.size(); i++) {B.addVariable(V[i]);}
+        for(size_t i = 0; (i < C.size())&&(!Fset.empty()); i++) {B.addConstant(C[i],Fset[0].getConstantValue((long)i));}
+
+        for(size_t j = 0; j < Fset.size(); j++)
+        {
+            const SymFun& G = Fset[j];
+            for(long i = 0; i < G.variableCount; i++) {B.addVariable(G.variableNames[i]);}
+            for(long i = 0; i < G.constantCount; i++) {B.addConstant(G.constantNames[i],G.constantValues[i]);}
+        }
+
+        std::vector<long>        outputs(Fset.size());
+        std::vector<std::string> Fstrings(Fset.size());
+        std::string S;
+
+        for(size_t j = 0; j < Fset.size(); j++)
+        {
+            const SymFun& G = Fset[j];
+            outputs[j] = (G.program) ? B.addProgram(*G.program,0,G.constantValues) : B.addLiteral("0");
+
+            Fstrings[j] = (G.program) ? G.getConstructorString() : std::string("0");
+            S += (j == 0) ? "{" : ", ";
+            S += Fstrings[j];
+        }
+        S += "}";
+
+        functionStrings = Fstrings;
+        operationCount  = B.getOperationCount();
+
+        if(outputs.empty()) {F.initialize(); outputSlots.clear(); return 0;}
+        return F.create(B,&outputs[0],(long)outputs.size(),outputSlots,S);
+    }
+
+    SymFun             F;               // the fused program
+    std::vector<long>  outputSlots;     // data slot of the value of each function
+    std::vector<std::string> functionStrings;
+    long               operationCount;
+};
+}
+#endif
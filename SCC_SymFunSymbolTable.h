@@ -0,0 +1,192 @@
+//
+//##################################################################
+//                     SCC_SymFunSymbolTable.h
+//##################################################################
+//
+// A process wide table of interned symbol names. Each distinct name
+// is stored once and is identified by an integer id.
+//
+// Chris Anderson (C) UCLA 2022
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <functional>
+#include <stdexcept>
+#include <mutex>
+#include <atomic>
+
+#ifndef SYMFUN_SYMBOL_TABLE_
+#define SYMFUN_SYMBOL_TABLE_
+
+namespace SCC
+{
+
+/*!
+ \class SCC::SymFunSymbolTable
+ \brief A process wide table of interned symbol names
+
+ The names of the variables and symbolic constants of SCC::SymFun instances are interned
+ in this table so that each distinct name is stored once, however many instances use it.
+ Names are never removed, so only identifiers, whose number is bounded in practice, are
+ interned; numeric literals and expression strings are not.
+ Names are identified by an integer id; the id of a name and the characters of a name
+ remain valid for the life of the process.
+
+ All member functions are static and may be called concurrently. The name to id
+ maps are divided into shards, each with its own lock, and the id to name lookup
+ does not lock.
+
+ \headerfile SCC_SymFunSymbolTable.h "SCC_SymFunSymbolTable.h"
+*/
+
+class SymFunSymbolTable
+{
+public:
+
+    /**
+     Returns the id of the name S, adding S to the table if it is not present.
+    */
+
+    static long getSymbolId(const std::string& S)
+    {
+        SymFunSymbolTable& table = getInstance();
+        Shard& shard = table.shards[std::hash<std::string>()(S) % shardCount];
+
+        std::lock_guard<std::mutex> lock(shard.shardMutex);
+
+        std::unordered_map<std::string,long>::const_iterator it = shard.symbolIds.find(S);
+        if(it != shard.symbolIds.end()) return it->second;
+
+        long id = table.addSymbolName(S);
+        shard.symbolIds[S] = id;
+        return id;
+    }
+
+    /**
+     Returns the id of the name S, or -1 if S is not in the table.
+    */
+
+    static long findSymbolId(const std::string& S)
+    {
+        SymFunSymbolTable& table = getInstance();
+        Shard& shard = table.shards[std::hash<std::string>()(S) % shardCount];
+
+        std::lock_guard<std::mutex> lock(shard.shardMutex);
+
+        std::unordered_map<std::string,long>::const_iterator it = shard.symbolIds.find(S);
+        if(it != shard.symbolIds.end()) return it->second;
+        return -1;
+    }
+
+    /**
+     Returns the name with the specified id. The pointer remains valid
+     for the life of the process.
+    */
+
+    static const char* getSymbolName(long id)
+    {
+        SymFunSymbolTable& table = getInstance();
+        const std::atomic<const char*>* block = table.blocks[id/blockSize].load(std::memory_order_acquire);
+        return block[id % blockSize].load(std::memory_order_acquire);
+    }
+
+    /**
+     Returns the number of names in the table.
+    */
+
+    static long getSymbolCount()
+    {
+        return getInstance().symbolCount.load();
+    }
+
+private:
+
+    enum {shardCount = 64, blockSize = 16384, maxBlockCount = 16384};
+
+    struct Shard
+    {
+        std::mutex                           shardMutex;
+        std::unordered_map<std::string,long> symbolIds;
+    };
+
+    SymFunSymbolTable()
+    {
+        symbolCount.store(0);
+        for(long i = 0; i < maxBlockCount; i++) {blocks[i].store(0);}
+    }
+
+    // The names and the blocks of the id to name array are never freed
+
+    static SymFunSymbolTable& getInstance()
+    {
+        static SymFunSymbolTable table;
+        return table;
+    }
+
+    //
+    // Stores a copy of S and returns its id. The id to name array is a
+    // sequence of fixed size blocks so that existing entries are never moved.
+    //
+
+    long addSymbolName(const std::string& S)
+    {
+        // The capacity is checked before the count is incremented and the name
+        // is allocated, so a full table leaves no gap in the ids and leaks nothing.
+
+        long id = symbolCount.load();
+        do
+        {
+            if(id >= (long)maxBlockCount*(long)blockSize)
+            {throw std::length_error("SCC::SymFunSymbolTable : symbol table is full");}
+        } while(!symbolCount.compare_exchange_weak(id,id + 1));
+
+        long blockIndex = id/blockSize;
+
+        char* name = new char[S.size() + 1];
+        memcpy(name, S.c_str(), S.size() + 1);
+
+        std::atomic<const char*>* block = blocks[blockIndex].load(std::memory_order_acquire);
+        if(block == 0)
+        {
+            std::lock_guard<std::mutex> lock(blockMutex);
+            block = blocks[blockIndex].load(std::memory_order_acquire);
+            if(block == 0)
+            {
+                block = new std::atomic<const char*>[blockSize];
+                for(long i = 0; i < blockSize; i++) {block[i].store(0,std::memory_order_relaxed);}
+                blocks[blockIndex].store(block,std::memory_order_release);
+            }
+        }
+
+        block[id % blockSize].store(name,std::memory_order_release);
+        return id;
+    }
+
+    Shard                                   shards[shardCount];
+    std::atomic<long>                       symbolCount;
+    std::mutex                              blockMutex;
+    std::atomic<std::atomic<const char*>*>  blocks[maxBlockCount];
+};
+}
+#endif
@@ -35,13 +35,19 @@
 #############################################################################
 */
 #include "SCC_SymFun.h"
+#include "SCC_SymFunProgramBuilder.h"
+#include "SCC_SymFunSymbolTable.h"
 
 
 
 #include <string>
 #include <cstring>
 #include <cstdlib>
+#include <cctype>
 #include <sstream>
+#include <vector>
+#include <map>
+#include <utility>
 
 //
 // strcpy_s is not implemented as part of C++11 (arrgh) so this macro
@@ -63,10 +69,11 @@ namespace SCC
 
 /*!
  \class SCC::SymFunUtility
-  \brief A class whose member functions differentiate SCC::SymFun instances
+  \brief A class whose member functions differentiate and compose SCC::SymFun instances
 
    SCC::SymUtility is a BETA version of a class that  provides member functions to evaluate the
-   derivative of a SymFun instance symbolically and return the result as a SymFun instance.
+   derivative of a SymFun instance symbolically and return the result as a SymFun instance, and
+   to compose SymFun instances.
 
    Required version of C++ : >=  C++11
 
@@ -132,17 +139,169 @@ SCC::SymFun differentiate(SCC::SymFun& F,const std::string& varName)
 	return symbolicDifferentiate(F,varName.c_str());
 }
 
+//
+//#####################################################################
+//                  compose
+//#####################################################################
+//
+/*!
+    Returns the SCC::SymFun instance obtained by substituting SCC::SymFun instances for
+    variables of F. substitutions[s].first is the name of a variable of F and substitutions[s].second
+    the function substituted for it; names that are not variables of F are ignored.
+
+    The compiled programs of the functions are spliced together; no expression is parsed. Operations
+    that are identical after the substitution are carried out once, so a function substituted for
+    several variables, or subexpressions common to the functions, are evaluated once.
+
+    The variables of the result are the variables of F that are not replaced followed by the variables
+    of the substituted functions, in order of appearance; variables with the same name are the same
+    variable. Symbolic constants with the same name are the same constant and take the value of the
+    first function (F, then the substituted functions in order) in which they occur.
+
+    A name that is a variable of the result and a symbolic constant of F or of a substituted function
+    (e.g. the constant a of F(u) = u + a and the variable a of G(a) = 2*a substituted for u) generates
+    an SCC::SymFunException, since the constructor string of the result would not specify the function.
+
+    @arg F             : The SCC::SymFun instance whose variables are replaced
+    @arg substitutions : (variable name, SCC::SymFun) pairs
+
+    <HR>
+    Sample usage composing F(u,v) with u = G(x,y) and v = H(x,y).
+	\code
+
+    SCC::SymFun F({"u","v"},"u*v + sin(u)");
+    SCC::SymFun G({"x","y"},"x^2 + y^2");
+    SCC::SymFun H({"x","y"},"x - y");
+
+    SCC::SymFunUtility symFunUtility;
+
+    SCC::SymFun FGH = symFunUtility.compose(F,{{"u",G},{"v",H}});   // a function of x and y
+
+    std::cout << FGH(1.0,2.0) << std::endl;
+    \endcode
+*/
+SCC::SymFun compose(const SCC::SymFun& F, const std::vector< std::pair<std::string,SCC::SymFun> >& substitutions)
+{
+    SCC::SymFun R;   // return argument
+    if(!F.program) return R;
+
+    long   i;
+    size_t s;
+    long variableCount = F.variableCount;
+//
+//  Identify the substitution of each variable of F
+//
+    std::vector<long> substitutionIndex(variableCount,-1);
+
+    for(s = 0; s < substitutions.size(); s++)
+    {
+    long nameId = SymFunSymbolTable::findSymbolId(substitutions[s].first);
+    for(i = 0; i < variableCount; i++)
+    {
+    if(F.program->variableIds[i] == nameId) substitutionIndex[i] = (long)s;
+    }}
+//
+//  The variables of F that are not replaced and the constants of F precede
+//  those of the substituted functions.
+//
+    SymFunProgramBuilder B;
+
+    for(i = 0; i < variableCount; i++)
+    {
+    if(substitutionIndex[i] < 0) B.addVariable(F.variableNames[i]);
+    }
+
+    for(i = 0; i < F.constantCount; i++)
+    {
+    B.addConstant(F.constantNames[i],F.constantValues[i]);
+    }
+//
+//  Splice the substituted functions, then F with its variables replaced
+//
+    std::vector<long> variableOperands(variableCount + 1);
+    std::vector<long> substitutionResult(substitutions.size(),-1);
+    std::map<std::string,std::string> substitutionStrings;
+
+    for(i = 0; i < variableCount; i++)
+    {
+    if(substitutionIndex[i] < 0)
+    {
+    variableOperands[i] = B.addVariable(F.variableNames[i]);
+    continue;
+    }
+
+    s = (size_t)substitutionIndex[i];
+    if(substitutionResult[s] < 0)
+    {
+    const SCC::SymFun& G = substitutions[s].second;
+    substitutionResult[s] = (G.program) ? B.addProgram(*G.program,0,G.constantValues) : B.addLiteral("0");
+    substitutionStrings[F.variableNames[i]] = "(" + ((G.program) ? G.getConstructorString() : std::string("0")) + ")";
+    }
+    variableOperands[i] = substitutionResult[s];
+    }
+
+    long result = B.addProgram(*F.program,&variableOperands[0],F.constantValues);
+
+    std::vector<long> outputSlots;
+    R.create(B,&result,1,outputSlots,substituteVariables(F.getConstructorString(),substitutionStrings));
+    return R;
+}
+
 
 protected:
 
+//
+// Returns S with each occurrence of a name that is a key of substitutionStrings
+// replaced by the corresponding value. Names are maximal sequences of letters,
+// digits and underscores that do not start with a digit; numbers (including
+// exponents such as 1.0e-3) are copied unchanged. The constructor string of a
+// composed function is created in this way, so that it specifies the function.
+//
+std::string substituteVariables(const std::string& S, const std::map<std::string,std::string>& substitutionStrings)
+{
+    std::string R;
+    size_t k = 0;
+    size_t kStart;
+
+    while(k < S.size())
+    {
+    unsigned char c = (unsigned char)S[k];
+    kStart = k;
+
+    if(isdigit(c)||(c == '.'))
+    {
+    while((k < S.size())&&(isdigit((unsigned char)S[k])||(S[k] == '.'))) {k++;}
+    if((k < S.size())&&((S[k] == 'e')||(S[k] == 'E')))
+    {
+    k++;
+    if((k < S.size())&&((S[k] == '+')||(S[k] == '-'))) {k++;}
+    while((k < S.size())&&isdigit((unsigned char)S[k])) {k++;}
+    }
+    R += S.substr(kStart,k - kStart);
+    }
+    else if(isalpha(c)||(c == '_'))
+    {
+    while((k < S.size())&&(isalnum((unsigned char)S[k])||(S[k] == '_'))) {k++;}
+    std::map<std::string,std::string>::const_iterator it = substitutionStrings.find(S.substr(kStart,k - kStart));
+    if(it != substitutionStrings.end()) {R += it->second;}
+    else                                {R += S.substr(kStart,k - kStart);}
+    }
+    else
+    {
+    R += S[k]; k++;
+    }
+    }
+    return R;
+}
+
 SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
 {
-    const char**V    = 0; // variable names  pointer
-    const char**C    = 0; // constant names  pointer
-    double* cV = 0; // constant values pointer
+    const char* const* V = 0; // variable names  pointer
+    const char* const* C = 0; // constant names  pointer
+    const double* cV = 0; // constant values pointer
 
-    V    = (const char**)F.getVariableNamePtr();
-    C    = (const char**)F.getConstantNamePtr();
+    V    = F.getVariableNamePtr();
+    C    = F.getConstantNamePtr();
     cV   = F.getConstantValuePtr();
 
 
@@ -152,8 +311,6 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
 
     SCC::SymFun D;   // return argument
 
-    SCC::RealOperatorLib  L;
-
     long    i;
     int     initReturn    = 0;
     long    functionIndex = 0;
@@ -244,50 +401,50 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     //
     if(argCount == 2)
     {
-    if      ((!strcmp(L.Symbols[functionIndex],"+"))||
-             (!strcmp(L.Symbols[functionIndex],"-")))
+    if      ((!strcmp(RealOperatorLib::Symbols[functionIndex],"+"))||
+             (!strcmp(RealOperatorLib::Symbols[functionIndex],"-")))
     {
      sSize = 4;
      sSize += (long)strlen(devaluationStrings[arg1Index]);
     }
-    else if((!strcmp(L.Symbols[functionIndex],"sin")) ||
-            (!strcmp(L.Symbols[functionIndex],"cos")) ||
-            (!strcmp(L.Symbols[functionIndex],"exp")) ||
-            (!strcmp(L.Symbols[functionIndex],"cosh"))||
-            (!strcmp(L.Symbols[functionIndex],"sinh"))
+    else if((!strcmp(RealOperatorLib::Symbols[functionIndex],"sin")) ||
+            (!strcmp(RealOperatorLib::Symbols[functionIndex],"cos")) ||
+            (!strcmp(RealOperatorLib::Symbols[functionIndex],"exp")) ||
+            (!strcmp(RealOperatorLib::Symbols[functionIndex],"cosh"))||
+            (!strcmp(RealOperatorLib::Symbols[functionIndex],"sinh"))
            )
     {
      sSize  = 20;
      sSize += (long)strlen(evaluationStrings[arg1Index]);
      sSize += (long)strlen(devaluationStrings[arg1Index]);
     }
-    else if((!strcmp(L.Symbols[functionIndex],"asin")) ||
-            (!strcmp(L.Symbols[functionIndex],"acos")) ||
-            (!strcmp(L.Symbols[functionIndex],"atan")))
+    else if((!strcmp(RealOperatorLib::Symbols[functionIndex],"asin")) ||
+            (!strcmp(RealOperatorLib::Symbols[functionIndex],"acos")) ||
+            (!strcmp(RealOperatorLib::Symbols[functionIndex],"atan")))
     {
      sSize  = 30;
      sSize += (long)strlen(evaluationStrings[arg1Index]);
      sSize += (long)strlen(devaluationStrings[arg1Index]);
     }
-    else if(!strcmp(L.Symbols[functionIndex],"log"))
+    else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"log"))
     {
      sSize  = 20;
      sSize += (long)strlen(evaluationStrings[arg1Index]);
      sSize += (long)strlen(devaluationStrings[arg1Index]);
     }
-    else if(!strcmp(L.Symbols[functionIndex],"log10"))
+    else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"log10"))
     {
      sSize  = 30;
      sSize += (long)strlen(evaluationStrings[arg1Index]);
      sSize += (long)strlen(devaluationStrings[arg1Index]);
     }
-    else if(!strcmp(L.Symbols[functionIndex],"sqrt"))
+    else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"sqrt"))
     {
      sSize  = 30;
      sSize += (long)strlen(evaluationStrings[arg1Index]);
      sSize += (long)strlen(devaluationStrings[arg1Index]);
     }
-    else if(!strcmp(L.Symbols[functionIndex],"tan"))
+    else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"tan"))
     {
      sSize  = 30;
      sSize += (long)strlen(evaluationStrings[arg1Index]);
@@ -296,14 +453,14 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     }
     if(argCount == 3)
     {
-    if     ((!strcmp(L.Symbols[functionIndex],"+"))||
-           (!strcmp(L.Symbols[functionIndex],"-")))
+    if     ((!strcmp(RealOperatorLib::Symbols[functionIndex],"+"))||
+           (!strcmp(RealOperatorLib::Symbols[functionIndex],"-")))
     {
     sSize  = 5;
     sSize += (long)strlen(devaluationStrings[arg1Index]);
     sSize += (long)strlen(devaluationStrings[arg2Index]);
     }
-    else if(!strcmp(L.Symbols[functionIndex],"*"))
+    else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"*"))
     {
     sSize  = 30;
     sSize += (long)strlen(devaluationStrings[arg1Index]);
@@ -311,7 +468,7 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     sSize += (long)strlen(evaluationStrings[arg1Index]);
     sSize += (long)strlen(evaluationStrings[arg2Index]);
     }
-    else if(!strcmp(L.Symbols[functionIndex],"/"))
+    else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"/"))
     {
     sSize  = 30;
     sSize +=   (long)strlen(devaluationStrings[arg1Index]);
@@ -319,8 +476,8 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     sSize +=   (long)strlen(evaluationStrings[arg1Index]);
     sSize += 2*(long)strlen(evaluationStrings[arg2Index]);
     }
-    else if((!strcmp(L.Symbols[functionIndex],"^"))||
-            (!strcmp(L.Symbols[functionIndex],"pow")))
+    else if((!strcmp(RealOperatorLib::Symbols[functionIndex],"^"))||
+            (!strcmp(RealOperatorLib::Symbols[functionIndex],"pow")))
     {
     sSize =  (long)strlen(devaluationStrings[arg1Index]);
     sSize += (long)strlen(devaluationStrings[arg2Index]);
@@ -345,14 +502,14 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     //                    + -
     //*********************************************
     //
-    if((!strcmp(L.Symbols[functionIndex],"+"))||
-    (!strcmp(L.Symbols[functionIndex],"-")))
+    if((!strcmp(RealOperatorLib::Symbols[functionIndex],"+"))||
+    (!strcmp(RealOperatorLib::Symbols[functionIndex],"-")))
     {
         if(strlen(devaluationStrings[arg1Index])==0)
         {sbuf << std::ends;}
         else
         {
-        sbuf << L.Symbols[functionIndex]      << "("
+        sbuf << RealOperatorLib::Symbols[functionIndex]      << "("
                 << devaluationStrings[arg1Index] << ")" << std::ends;
         }
     }
@@ -361,19 +518,19 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     //  sin, cos, exp, cosh, sinh
     //*********************************************
     //
-    else if((!strcmp(L.Symbols[functionIndex],"sin")) ||
-            (!strcmp(L.Symbols[functionIndex],"cos")) ||
-            (!strcmp(L.Symbols[functionIndex],"exp")) ||
-            (!strcmp(L.Symbols[functionIndex],"cosh"))||
-            (!strcmp(L.Symbols[functionIndex],"sinh"))
+    else if((!strcmp(RealOperatorLib::Symbols[functionIndex],"sin")) ||
+            (!strcmp(RealOperatorLib::Symbols[functionIndex],"cos")) ||
+            (!strcmp(RealOperatorLib::Symbols[functionIndex],"exp")) ||
+            (!strcmp(RealOperatorLib::Symbols[functionIndex],"cosh"))||
+            (!strcmp(RealOperatorLib::Symbols[functionIndex],"sinh"))
            )
     {
 
-    if      (!strcmp(L.Symbols[functionIndex],"sin"))   COPYSTR(dfunctionString,4, "cos");
-    else if (!strcmp(L.Symbols[functionIndex],"cos"))   COPYSTR(dfunctionString,5,"-sin");
-    else if (!strcmp(L.Symbols[functionIndex],"exp"))   COPYSTR(dfunctionString,4,"exp");
-    else if (!strcmp(L.Symbols[functionIndex],"cosh"))  COPYSTR(dfunctionString,5,"sinh");
-    else if (!strcmp(L.Symbols[functionIndex],"sinh"))  COPYSTR(dfunctionString,5,"cosh");
+    if      (!strcmp(RealOperatorLib::Symbols[functionIndex],"sin"))   COPYSTR(dfunctionString,4, "cos");
+    else if (!strcmp(RealOperatorLib::Symbols[functionIndex],"cos"))   COPYSTR(dfunctionString,5,"-sin");
+    else if (!strcmp(RealOperatorLib::Symbols[functionIndex],"exp"))   COPYSTR(dfunctionString,4,"exp");
+    else if (!strcmp(RealOperatorLib::Symbols[functionIndex],"cosh"))  COPYSTR(dfunctionString,5,"sinh");
+    else if (!strcmp(RealOperatorLib::Symbols[functionIndex],"sinh"))  COPYSTR(dfunctionString,5,"cosh");
 
         if(strlen(devaluationStrings[arg1Index])==0)
         {sbuf << std::ends;}
@@ -396,9 +553,9 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     //  asin, acos, atan
     //*********************************************
     //
-    else if((!strcmp(L.Symbols[functionIndex],"asin")) ||
-            (!strcmp(L.Symbols[functionIndex],"acos")) ||
-            (!strcmp(L.Symbols[functionIndex],"atan")))
+    else if((!strcmp(RealOperatorLib::Symbols[functionIndex],"asin")) ||
+            (!strcmp(RealOperatorLib::Symbols[functionIndex],"acos")) ||
+            (!strcmp(RealOperatorLib::Symbols[functionIndex],"atan")))
     {
         if(strlen(devaluationStrings[arg1Index])==0)
         {sbuf << std::ends;}
@@ -408,18 +565,18 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
           ||(!strcmp(devaluationStrings[arg1Index],"(1)")))
           {
 
-          if     (!strcmp(L.Symbols[functionIndex],"asin")) {(sbuf) << "(1./sqrt(1.-(";}
-          else if(!strcmp(L.Symbols[functionIndex],"acos")) {(sbuf) << "(-1./sqrt(1-(";}
-          else if(!strcmp(L.Symbols[functionIndex],"atan")) {(sbuf) << "(1./(1.+(";}
+          if     (!strcmp(RealOperatorLib::Symbols[functionIndex],"asin")) {(sbuf) << "(1./sqrt(1.-(";}
+          else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"acos")) {(sbuf) << "(-1./sqrt(1-(";}
+          else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"atan")) {(sbuf) << "(1./(1.+(";}
 
           sbuf << evaluationStrings[arg1Index] << ")^2))" << std::ends;
           }
           else
           {
 
-          if     (!strcmp(L.Symbols[functionIndex],"asin")) {(sbuf) <<"((1./sqrt(1.-(";}
-          else if(!strcmp(L.Symbols[functionIndex],"acos")) {(sbuf) <<"((-1./sqrt(1-(";}
-          else if(!strcmp(L.Symbols[functionIndex],"atan")) {(sbuf) <<"((1./(1.+(";}
+          if     (!strcmp(RealOperatorLib::Symbols[functionIndex],"asin")) {(sbuf) <<"((1./sqrt(1.-(";}
+          else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"acos")) {(sbuf) <<"((-1./sqrt(1-(";}
+          else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"atan")) {(sbuf) <<"((1./(1.+(";}
 
           sbuf <<evaluationStrings[arg1Index] << ")^2))" << "*"
           << "(" << devaluationStrings[arg1Index] << "))" << std::ends;
@@ -431,7 +588,7 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     //                   log(x)
     //*********************************************
     //
-    else if(!strcmp(L.Symbols[functionIndex],"log"))
+    else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"log"))
     {
         if(strlen(devaluationStrings[arg1Index])==0)
         {sbuf << std::ends;}
@@ -453,7 +610,7 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     //                   log10(x)
     //*********************************************
     //
-    else if(!strcmp(L.Symbols[functionIndex],"log10"))
+    else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"log10"))
     {
         if(strlen(devaluationStrings[arg1Index])==0)
         {sbuf << std::ends;}
@@ -477,7 +634,7 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     //                   sqrt(x)
     //*********************************************
     //
-    else if(!strcmp(L.Symbols[functionIndex],"sqrt"))
+    else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"sqrt"))
     {
         if(strlen(devaluationStrings[arg1Index])==0)
         {sbuf << std::ends;}
@@ -500,7 +657,7 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     //                   tan(x)
     //*********************************************
     //
-    else if(!strcmp(L.Symbols[functionIndex],"tan"))
+    else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"tan"))
     {
         if(strlen(devaluationStrings[arg1Index])==0)
         {sbuf << std::ends;}
@@ -532,8 +689,8 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     //                  +   -
     //**************************************************
     //
-    if((!strcmp(L.Symbols[functionIndex],"+"))||
-       (!strcmp(L.Symbols[functionIndex],"-")))
+    if((!strcmp(RealOperatorLib::Symbols[functionIndex],"+"))||
+       (!strcmp(RealOperatorLib::Symbols[functionIndex],"-")))
     {
 
     if((strlen(devaluationStrings[arg1Index])==0)&&
@@ -542,7 +699,7 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     else
     if(strlen(devaluationStrings[arg2Index]) != 0)
     {
-        sbuf << "(" << devaluationStrings[arg1Index] << L.Symbols[functionIndex] <<
+        sbuf << "(" << devaluationStrings[arg1Index] << RealOperatorLib::Symbols[functionIndex] <<
         devaluationStrings[arg2Index] << ")" << std::ends;
     }
     else
@@ -554,7 +711,7 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     //                      *
     //**************************************************
     //
-    else if(!strcmp(L.Symbols[functionIndex],"*"))
+    else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"*"))
     {
     if((strlen(devaluationStrings[arg1Index])==0)&&
        (strlen(devaluationStrings[arg2Index])==0))
@@ -604,7 +761,7 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     //                      /
     //**************************************************
     //
-    else if(!strcmp(L.Symbols[functionIndex],"/"))
+    else if(!strcmp(RealOperatorLib::Symbols[functionIndex],"/"))
     {
     if((strlen(devaluationStrings[arg1Index])==0)&&
        (strlen(devaluationStrings[arg2Index])==0))
@@ -654,8 +811,8 @@ SCC::SymFun symbolicDifferentiate(SCC::SymFun& F,const char* var)
     // need to clean up things when the exponent is an
     // integer
     //
-    else if((!strcmp(L.Symbols[functionIndex],"^"))||
-            (!strcmp(L.Symbols[functionIndex],"pow")))
+    else if((!strcmp(RealOperatorLib::Symbols[functionIndex],"^"))||
+            (!strcmp(RealOperatorLib::Symbols[functionIndex],"pow")))
     {
     if((strlen(devaluationStrings[arg1Index])==0)&&
     (strlen(devaluationStrings[arg2Index])==0))
@@ -895,8 +1052,6 @@ void createEvaluationStrings(SCC::SymFun& F, char** evaluationStrings,
 long* evaluationPriority)
 {
 
-    SCC::RealOperatorLib  L;
-
     std::ostringstream sbuf;
     sbuf.str("");
 
@@ -939,7 +1094,7 @@ long* evaluationPriority)
     argCount      = F.executionArray[executionIndex]; executionIndex++;
     resultIndex   = F.executionArray[executionIndex+(argCount-1)];
 
-    centPriority = L.Priority[functionIndex];
+    centPriority = RealOperatorLib::Priority[functionIndex];
 //
 //  ++++++++++++++++++++++++++++++++++++++++++++++++++
 //
@@ -951,14 +1106,14 @@ long* evaluationPriority)
      stringSize += (long)strlen(evaluationStrings[F.executionArray[executionIndex+j]]);
     }
 
-    stringSize  += (long)strlen(L.Symbols[functionIndex]);
+    stringSize  += (long)strlen(RealOperatorLib::Symbols[functionIndex]);
     stringSize  += 4; //for ()'s
 //
 //  Special case binary operators
 //
-    if(!strcmp(L.Symbols[functionIndex],"atan2")) stringSize++; // for ,
-    if(!strcmp(L.Symbols[functionIndex],"pow"))   stringSize++; // for ,
-    if(!strcmp(L.Symbols[functionIndex],"fmod"))  stringSize++; // for ,
+    if(!strcmp(RealOperatorLib::Symbols[functionIndex],"atan2")) stringSize++; // for ,
+    if(!strcmp(RealOperatorLib::Symbols[functionIndex],"pow"))   stringSize++; // for ,
+    if(!strcmp(RealOperatorLib::Symbols[functionIndex],"fmod"))  stringSize++; // for ,
 //
 //  +++++++++++++++++++++++++++++++++++++++++++++++++
 //
@@ -972,19 +1127,19 @@ long* evaluationPriority)
        (argIndex >= F.constantCount + F.variableCount))
        &&
        (
-       (!strcmp(L.Symbols[functionIndex],"+"))||
-       (!strcmp(L.Symbols[functionIndex],"-"))||
-       (!strcmp(L.Symbols[functionIndex],"*"))||
-       (!strcmp(L.Symbols[functionIndex],"/"))
+       (!strcmp(RealOperatorLib::Symbols[functionIndex],"+"))||
+       (!strcmp(RealOperatorLib::Symbols[functionIndex],"-"))||
+       (!strcmp(RealOperatorLib::Symbols[functionIndex],"*"))||
+       (!strcmp(RealOperatorLib::Symbols[functionIndex],"/"))
        )
     )
     {
-    sbuf << L.Symbols[functionIndex]
+    sbuf << RealOperatorLib::Symbols[functionIndex]
     << evaluationStrings[F.executionArray[executionIndex]] << std::ends;
     }
     else
     {
-    sbuf << L.Symbols[functionIndex]
+    sbuf << RealOperatorLib::Symbols[functionIndex]
     << "(" << evaluationStrings[F.executionArray[executionIndex]] << ")" << std::ends;
     }
 
@@ -992,17 +1147,17 @@ long* evaluationPriority)
 
     else if(argCount == 3)
     {
-    if((!strcmp(L.Symbols[functionIndex],"atan2"))||
-       (!strcmp(L.Symbols[functionIndex],"pow"))||
-       (!strcmp(L.Symbols[functionIndex],"fmod")))
+    if((!strcmp(RealOperatorLib::Symbols[functionIndex],"atan2"))||
+       (!strcmp(RealOperatorLib::Symbols[functionIndex],"pow"))||
+       (!strcmp(RealOperatorLib::Symbols[functionIndex],"fmod")))
     {
-    sbuf << L.Symbols[functionIndex] << "("
+    sbuf << RealOperatorLib::Symbols[functionIndex] << "("
     << evaluationStrings[F.executionArray[executionIndex]] << ","
     << evaluationStrings[F.executionArray[executionIndex+1]] << ")" << std::ends;
     }
     else
     {
-        if(!strcmp(L.Symbols[functionIndex],"^")) // convert ^ to pow symbol
+        if(!strcmp(RealOperatorLib::Symbols[functionIndex],"^")) // convert ^ to pow symbol
 
         {
             sbuf << "pow("
@@ -1014,7 +1169,7 @@ long* evaluationPriority)
 
         leftPriority = evaluationPriority[F.executionArray[executionIndex]];
         rghtPriority = evaluationPriority[F.executionArray[executionIndex+1]];
-        centPriority = L.Priority[functionIndex];
+        centPriority = RealOperatorLib::Priority[functionIndex];
 
         if(leftPriority >= centPriority)
         {
@@ -1025,7 +1180,7 @@ long* evaluationPriority)
         sbuf << evaluationStrings[F.executionArray[executionIndex]];
         }
 
-        sbuf << L.Symbols[functionIndex];
+        sbuf << RealOperatorLib::Symbols[functionIndex];
 
         if(rghtPriority >= centPriority)
         {
@@ -0,0 +1,270 @@
+//
+//##################################################################
+//                     SCC_SymFunView.h
+//##################################################################
+//
+// Lightweight callable objects that evaluate SCC::SymFun instances:
+// a non-owning view, SCC::SymFunView, and an owning handle,
+// SCC::SymFunHandle. Both provide a function pointer and context
+// pair for use with C style interfaces.
+//
+// Chris Anderson (C) UCLA 2022
+//
+/*
+#############################################################################
+#
+# Copyright 1996-2022 Chris Anderson
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# For a copy of the GNU General Public License see
+# <http://www.gnu.org/licenses/>.
+#
+#############################################################################
+*/
+#include <memory>
+#include <sstream>
+
+#include "SCC_SymFun.h"
+
+#ifndef SYMFUN_VIEW_
+#define SYMFUN_VIEW_
+
+namespace SCC
+{
+
+/*!
+ \class SCC::SymFunView
+ \brief A non-owning callable view of an SCC::SymFun instance
+
+ An SCC::SymFunView holds only a pointer to an SCC::SymFun instance. It can be copied
+ and passed by value at the cost of a pointer, and its evaluation operators are inline,
+ so templated solvers that accept a callable type evaluate the function without the
+ type erasure (and possible heap allocation) of a std::function.
+
+ For C style interfaces that accept a function pointer and a context pointer,
+ getFunctionPtr() and getContext() return a function of type
+
+ double (*)(void* context, const double* x)
+
+ and the context with which it is to be called.
+
+ The viewed instance must outlive the view. As with the SCC::SymFun evaluation
+ operators, evaluation uses the evaluation data of the viewed instance, so a view
+ should not be used by more than one thread at a time.
+
+ Sample:
+ \code
+    SCC::SymFun F({"x","y"},"x^2 + y^2");
+    SCC::SymFunView Fview(F);
+
+    double f = Fview(1.0,2.0);
+
+    double x[] = {1.0,2.0};
+    double g = Fview.getFunctionPtr()(Fview.getContext(),x);
+ \endcode
+
+ \headerfile SCC_SymFunView.h "SCC_SymFunView.h"
+*/
+
+class SymFunView
+{
+public:
+
+    typedef double (*FunctionPtr)(void* context, const double* x);
+
+    SymFunView() : F(0) {}
+
+    SymFunView(const SymFun& F) : F(&F) {}
+
+    /**
+     Returns the value of the function at the point x[0], ..., x[V-1], where V
+     is the number of variables.
+    */
+
+    double evaluate(const double* x) const
+    {
+        return evaluate(F,x);
+    }
+
+    /**
+     Returns the value of the function at the point specified by the arguments. An
+     SCC::SymFunException is generated if the number of arguments is not the number
+     of variables.
+    */
+
+    double operator()(double x1) const
+    {
+        if(F->variableCount != 1) argError(1);
+        return evaluate(F,&x1);
+    }
+
+    double operator()(double x1, double x2) const
+    {
+        if(F->variableCount != 2) argError(2);
+        double x[] = {x1,x2};
+        return evaluate(F,x);
+    }
+
+    double operator()(double x1, double x2, double x3) const
+    {
+        if(F->variableCount != 3) argError(3);
+        double x[] = {x1,x2,x3};
+        return evaluate(F,x);
+    }
+
+    double operator()(double x1, double x2, double x3, double x4) const
+    {
+        if(F->variableCount != 4) argError(4);
+        double x[] = {x1,x2,x3,x4};
+        return evaluate(F,x);
+    }
+
+    /**
+     Returns a function that evaluates the viewed instance when called
+     with the context returned by getContext().
+    */
+
+    FunctionPtr getFunctionPtr() const
+    {
+        return &SymFunView::evaluateContext;
+    }
+
+    void* getContext() const
+    {
+        return const_cast<SymFun*>(F);
+    }
+
+    /**
+     Evaluates the SCC::SymFun instance context at the point x[0], ..., x[V-1].
+    */
+
+    static double evaluateContext(void* context, const double* x)
+    {
+        return evaluate((const SymFun*)context,x);
+    }
+
+    const SymFun* getSymFunPtr() const
+    {
+        return F;
+    }
+
+protected:
+
+    //
+    // The arguments are placed directly in the evaluation data of F; there is
+    // no check of the number of arguments, which the evaluation operators check
+    // and the callers of evaluate(x) and of the context function must ensure.
+    //
+
+    static double evaluate(const SymFun* F, const double* x)
+    {
+        if(F->evaluationData == 0) F->createEvaluationData();
+
+        double* data = F->evaluationData;
+        for(long i = 0; i < F->variableCount; i++) {data[i] = x[i];}
+        return F->evaluate();
+    }
+
+    void argError(long argCount) const
+    {
+        std::ostringstream errInfo;
+        errInfo << "Called with " << argCount << " arguments, expecting " << F->variableCount;
+        throw SymFunException("Incorrect number of arguments in SymFunView",errInfo.str(),
+                              F->constructorString);
+    }
+
+    const SymFun* F;
+};
+
+/*!
+ \class SCC::SymFunHandle
+ \brief An owning callable handle to an SCC::SymFun instance
+
+ An SCC::SymFunHandle holds a reference counted copy of an SCC::SymFun instance. The
+ copy shares the compiled program of the instance it is created from, so creating a
+ handle does not recompile the function, and the handle keeps the program alive
+ after the original instance is destroyed. Copies of a handle share the same instance.
+
+ The function pointer and context pair returned by getFunctionPtr() and getContext()
+ remain valid as long as the handle, or a copy of it, exists.
+
+ As with SCC::SymFunView, a handle and its copies should not be used by more than one thread
+ at a time; use separate handles (created from the same SCC::SymFun) for separate threads.
+
+ \headerfile SCC_SymFunView.h "SCC_SymFunView.h"
+*/
+
+class SymFunHandle
+{
+public:
+
+    typedef SymFunView::FunctionPtr FunctionPtr;
+
+    SymFunHandle() {}
+
+    SymFunHandle(const SymFun& F) : F(std::make_shared<SymFun>(F)) {}
+
+    double evaluate(const double* x) const
+    {
+        return SymFunView::evaluateContext(F.get(),x);
+    }
+
+    double operator()(double x1) const
+    {
+        return SymFunView(*F)(x1);
+    }
+
+    double operator()(double x1, double x2) const
+    {
+        return SymFunView(*F)(x1,x2);
+    }
+
+    double operator()(double x1, double x2, double x3) const
+    {
+        return SymFunView(*F)(x1,x2,x3);
+    }
+
+    double operator()(double x1, double x2, double x3, double x4) const
+    {
+        return SymFunView(*F)(x1,x2,x3,x4);
+    }
+
+    /**
+     Returns a non-owning view of the instance held by the handle.
+    */
+
+    SymFunView getView() const
+    {
+        return SymFunView(*F);
+    }
+
+    FunctionPtr getFunctionPtr() const
+    {
+        return &SymFunView::evaluateContext;
+    }
+
+    void* getContext() const
+    {
+        return F.get();
+    }
+
+    const SymFun& getSymFun() const
+    {
+        return *F;
+    }
+
+protected:
+
+    std::shared_ptr<SymFun> F;
+};
+}
+#endif
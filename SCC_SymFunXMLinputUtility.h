@@ -75,6 +75,7 @@
 #include "XML_ParameterList/XML_ParameterListArray.h"
 #include "XML_ParameterList/XML_ParameterCheck.h"
 #include "SymFun20/SCC_SymFun.h"
+#include "SymFun20/SCC_LazySymFun.h"
 
 #ifndef SYM_FUN_XML_INPUT_UTILITY_
 #define SYM_FUN_XML_INPUT_UTILITY_
@@ -92,15 +93,70 @@ public:
 	void initSymFunFromXML(const std::string& functionParamListName,const XML_ParameterListArray& paramList,
 	SCC::SymFun& F, bool verboseFlag = false)
 	{
+    std::string                funString;
+    std::vector <std::string > variableNames;
+    std::vector <std::string > coefficientNames;
+    std::vector <double>       coefficientValues;
+
+    getSpecificationFromXML(functionParamListName,paramList,funString,variableNames,
+                            coefficientNames,coefficientValues,verboseFlag);
+
+    try
+    {F.initialize(variableNames,coefficientNames,coefficientValues,funString);}
+    catch (const SCC::SymFunException& e)
+    {
+    	  std::string errMsg = "\n";
+    	  errMsg.append(e.what());
+    	  errMsg.append("\n");
+          throw std::runtime_error(errMsg);
+    }
+
+    if(verboseFlag)
+    {printf("F = %s \n",(F.getConstructorString()).c_str());}
+
+	}
+
+	// Initializes F with the specification of the function; the function is compiled
+	// when first evaluated (see SCC::LazySymFun). Syntax errors are reported (with an
+	// SCC::SymFunException) when the function is compiled.
+
+	void initSymFunFromXML(const std::string& functionParamListName,const XML_ParameterListArray& paramList,
+	SCC::LazySymFun& F, bool verboseFlag = false)
+	{
+    std::string                funString;
+    std::vector <std::string > variableNames;
+    std::vector <std::string > coefficientNames;
+    std::vector <double>       coefficientValues;
+
+    getSpecificationFromXML(functionParamListName,paramList,funString,variableNames,
+                            coefficientNames,coefficientValues,verboseFlag);
+
+    F.initialize(variableNames,coefficientNames,coefficientValues,funString);
+
+    if(verboseFlag)
+    {printf("F = %s \n",(F.getConstructorString()).c_str());}
+	}
+
+	// Captures the function string, the variable names ordered by coordinate index,
+	// and the coefficient names and initial values.
+
+	void getSpecificationFromXML(const std::string& functionParamListName,const XML_ParameterListArray& paramList,
+	std::string& funString, std::vector < std::string >& variableNames, std::vector <std::string >& coefficientNames,
+	std::vector <double>& coefficientValues, bool verboseFlag = false)
+	{
    // Capture function string and replace any carriage returns and/or line feeds with spaces
 
-    std::string funString = (std::string)paramList.getParameterValue("functionString",functionParamListName);
+    funString = (std::string)paramList.getParameterValue("functionString",functionParamListName);
 	std::replace(funString.begin(),funString.end(), '\n', ' ');
 	std::replace(funString.begin(),funString.end(), '\r', ' ');
 
     std::vector < std::string > variableNamesInput;
-    std::vector < std::string > variableNames;
     long variableCount;
+
+    variableNames.clear();
+    coefficientNames.clear();
+    coefficientValues.clear();
+
     if(paramList.isParameter("variables",functionParamListName))
     {
     	paramList.getParameterChildNames(0, "variables",functionParamListName,variableNamesInput);
@@ -129,9 +185,6 @@ public:
 
     // Capture the coefficient names and initial coefficient values
 
-    std::vector <std::string > coefficientNames;
-    std::vector <double>      coefficientValues;
-
     long coefficientCount;
 
     if(paramList.isParameter("symbolicConstants",functionParamListName))
@@ -147,20 +200,6 @@ public:
     	{printf("%s  = %15.5e \n",coefficientNames[k].c_str(),coefficientValues[k]);}
     }
     }
-
-    try
-    {F.initialize(variableNames,coefficientNames,coefficientValues,funString);}
-    catch (const SCC::SymFunException& e)
-    {
-    	  std::string errMsg = "\n";
-    	  errMsg.append(e.what());
-    	  errMsg.append("\n");
-          throw std::runtime_error(errMsg);
-    }
-
-    if(verboseFlag)
-    {printf("F = %s \n",(F.getConstructorString()).c_str());}
-
 	}
 
     void getCoefficientMapFromXML(std::string& functionParamListName, XML_ParameterListArray& paramList,
@@ -0,0 +1,138 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "SCC_SymFun.h"
+#include "SCC_SymFunEvaluationPlan.h"
+#include "SCC_SymFunEvaluationPlanner.h"
+
+//
+//######################################################################
+//
+// SymFun Test Program #3
+//
+// Evaluates a function of two variables at a batch of points with each
+// of the batch evaluation backends (scalar, block and threaded block
+// interpreter), in double and float, and with the plan selected by an
+// SCC::SymFunEvaluationPlanner.
+//
+// OUTPUT :
+// ------
+// The maximum difference between the batch values and the values
+// obtained by evaluating the function at each point with the
+// SCC::SymFun evaluation operator.
+//
+//######################################################################
+//
+int main()
+{
+    std::vector<std::string>  V = {"x","y"};
+    std::string S = "exp(-(x^2 + y^2))*sin(3*x) + sqrt(abs(x*y)) - y/(1 + x^2)";
+
+    SCC::SymFun f;
+
+    try
+    {
+    	f.initialize(V,S);
+    }
+    catch (const SCC::SymFunException& e)
+    {
+      std::cerr << e.what() << std::endl;
+      std::cerr << "XXXX Execution Terminated XXXXX" << std::endl;
+      return 1;
+    }
+
+    std::cout << "The function specified : ";
+    std::cout << f.getConstructorString()  << std::endl << std::endl;
+
+    // Evaluation points, a batch size that is not a multiple of the block size
+
+    long n = 1000;
+
+    std::vector<double> x(n);
+    std::vector<double> y(n);
+    std::vector<double> fScalar(n);
+
+    for(long k = 0; k < n; k++)
+    {
+    x[k] = -2.0 + 4.0*k/(n-1);
+    y[k] =  1.0 - 3.0*k/(n-1);
+    fScalar[k] = f(x[k],y[k]);
+    }
+
+    const double* X[] = {&x[0],&y[0]};
+    std::vector<double> fBatch(n);
+
+    SCC::SymFunEvaluationPlan plans[] =
+    {SCC::SymFunEvaluationPlan(SCC::SymFunEvaluationPlan::SCALAR,1,1),
+     SCC::SymFunEvaluationPlan(SCC::SymFunEvaluationPlan::BLOCK,64,1),
+     SCC::SymFunEvaluationPlan(SCC::SymFunEvaluationPlan::THREADED,64,4)};
+
+    const char* planNames[] = {"SCALAR  ","BLOCK   ","THREADED"};
+
+    double diff;
+    double maxDiff = 0.0;
+
+    for(long p = 0; p < 3; p++)
+    {
+    f.evaluateBatch(X,n,&fBatch[0],plans[p]);
+
+    diff = 0.0;
+    for(long k = 0; k < n; k++) {diff = std::max(diff,std::abs(fBatch[k] - fScalar[k]));}
+    maxDiff = std::max(maxDiff,diff);
+
+    std::cout << planNames[p] << " backend, double : maximum difference = " << diff << std::endl;
+    }
+
+    // Single precision evaluation of the same points
+
+    std::vector<float> xf(x.begin(),x.end());
+    std::vector<float> yf(y.begin(),y.end());
+    std::vector<float> fFloat(n);
+
+    const float* Xf[] = {&xf[0],&yf[0]};
+
+    double diffFloat = 0.0;
+    for(long p = 0; p < 3; p++)
+    {
+    f.evaluateBatch(Xf,n,&fFloat[0],plans[p]);
+
+    diff = 0.0;
+    for(long k = 0; k < n; k++) {diff = std::max(diff,std::abs(fFloat[k] - f((double)xf[k],(double)yf[k])));}
+    diffFloat = std::max(diffFloat,diff);
+
+    std::cout << planNames[p] << " backend, float  : maximum difference = " << diff << std::endl;
+    }
+
+    // The plan selected by the planner (cost model, no tuning file)
+
+    SCC::SymFunEvaluationPlanner planner;
+    SCC::SymFunEvaluationPlan plan = planner.getPlan(f,n);
+
+    f.evaluateBatch(X,n,&fBatch[0],plan);
+
+    diff = 0.0;
+    for(long k = 0; k < n; k++) {diff = std::max(diff,std::abs(fBatch[k] - fScalar[k]));}
+    maxDiff = std::max(maxDiff,diff);
+
+    std::cout << std::endl;
+    std::cout << "Planner : backend " << plan.backend << ", block size " << plan.blockSize
+              << ", thread count " << plan.threadCount << std::endl;
+    std::cout << "Planner plan, double : maximum difference = " << diff << std::endl << std::endl;
+
+    // The block operators may be vectorized, so the double values are compared with a
+    // tolerance of a few units in the last place; the float values with a float tolerance.
+
+    if((maxDiff > 1.0e-13)||(diffFloat > 1.0e-5))
+    {
+      std::cerr << "Batch values differ from the scalar values" << std::endl;
+      std::cerr << "XXXX Execution Terminated XXXXX" << std::endl;
+      return 1;
+    }
+
+    printf("XXXX Execution Complete XXXXX\n");
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "SCC_SymFun.h"
+#include "SCC_SymFunSet.h"
+
+//
+//######################################################################
+//
+// SymFun Test Program #4
+//
+// Creates an SCC::SymFunSet for the components of the gradient of
+// exp(-a*x*y) and the function itself, which share the subexpression
+// exp(-a*x*y), and evaluates the set at a point and at a batch of points.
+//
+// An SCC::SymFunSet is then created from two SCC::SymFun instances in
+// which y is a variable of one and a symbolic constant of the other;
+// this generates an SCC::SymFunException.
+//
+// OUTPUT :
+// ------
+// The values of the functions of the set, the operation count of the
+// fused program and of the separate programs, and the maximum difference
+// between the values of the set and the values of the separate functions.
+//
+//######################################################################
+//
+int main()
+{
+    std::vector<std::string>  V = {"x","y"};
+    std::vector<std::string>  C = {"a"};
+    std::vector<double>  Cvalues = {0.5};
+
+    std::vector<std::string>  S = {"-a*y*exp(-a*x*y)", "-a*x*exp(-a*x*y)", "exp(-a*x*y)"};
+
+    SCC::SymFunSet F;
+    std::vector<SCC::SymFun> G(S.size());
+
+    try
+    {
+    	F.initialize(V,C,Cvalues,S);
+    	for(size_t j = 0; j < S.size(); j++) {G[j].initialize(V,C,Cvalues,S[j]);}
+    }
+    catch (const SCC::SymFunException& e)
+    {
+      std::cerr << e.what() << std::endl;
+      std::cerr << "XXXX Execution Terminated XXXXX" << std::endl;
+      return 1;
+    }
+
+    long m = F.getFunctionCount();
+
+    long separateCount = 0;
+    for(long j = 0; j < m; j++)
+    {
+    SCC::SymFunSet Gj(V,C,Cvalues,{S[j]});
+    separateCount += Gj.getOperationCount();
+    }
+
+    std::cout << "Operation count of the fused program     : " << F.getOperationCount() << std::endl;
+    std::cout << "Operation count of the separate programs : " << separateCount << std::endl << std::endl;
+
+    // Evaluation at a point
+
+    double x[] = {1.0,2.0};
+    std::vector<double> f(m);
+
+    F.evaluate(x,&f[0]);
+
+    double maxDiff = 0.0;
+    for(long j = 0; j < m; j++)
+    {
+    std::cout << F.getFunctionString(j) << " at (1,2) = " << f[j] << std::endl;
+    maxDiff = std::max(maxDiff,std::abs(f[j] - G[j](x[0],x[1])));
+    }
+    std::cout << std::endl;
+
+    // Evaluation at a batch of points after changing the value of the constant
+
+    F.setConstantValue("a",2.0);
+    for(long j = 0; j < m; j++) {G[j].setConstantValue("a",2.0);}
+
+    long n = 500;
+
+    std::vector<double> xv(n);
+    std::vector<double> yv(n);
+    for(long k = 0; k < n; k++) {xv[k] = 0.01*k; yv[k] = 1.0 - 0.002*k;}
+
+    std::vector< std::vector<double> > fv(m,std::vector<double>(n));
+
+    const double* X[] = {&xv[0],&yv[0]};
+    std::vector<double*> Fvalues(m);
+    for(long j = 0; j < m; j++) {Fvalues[j] = &fv[j][0];}
+
+    F.evaluateBatch(X,n,&Fvalues[0]);
+
+    for(long j = 0; j < m; j++)
+    {
+    for(long k = 0; k < n; k++) {maxDiff = std::max(maxDiff,std::abs(fv[j][k] - G[j](xv[k],yv[k])));}
+    }
+
+    std::cout << "Maximum difference from the separate functions : " << maxDiff << std::endl << std::endl;
+
+    if(maxDiff > 1.0e-13)
+    {
+      std::cerr << "SymFunSet values differ from the SymFun values" << std::endl;
+      std::cerr << "XXXX Execution Terminated XXXXX" << std::endl;
+      return 1;
+    }
+
+    // y is a variable of P and a symbolic constant of Q
+
+    SCC::SymFun P({"x","y"},"x*y");
+    SCC::SymFun Q({"x"},{"y"},{3.0},"x + y");
+
+    bool collisionDetected = false;
+    try
+    {
+    	SCC::SymFunSet PQ(std::vector<SCC::SymFun>({P,Q}));
+    }
+    catch (const SCC::SymFunException& e)
+    {
+      std::cout << "Set of x*y (variable y) and x + y (constant y) : " << std::endl;
+      std::cout << e.what() << std::endl;
+      collisionDetected = true;
+    }
+
+    if(!collisionDetected)
+    {
+      std::cerr << "Variable and constant with the same name not detected" << std::endl;
+      std::cerr << "XXXX Execution Terminated XXXXX" << std::endl;
+      return 1;
+    }
+
+    printf("XXXX Execution Complete XXXXX\n");
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "SCC_SymFun.h"
+#include "SCC_SymFunUtility.h"
+
+//
+//######################################################################
+//
+// SymFun Test Program #5
+//
+// Composes F(u,v) = u*v + sin(u) with u = G(x,y) and v = H(x,y) using
+// SCC::SymFunUtility::compose and compares the result with the function
+// specified directly in terms of x and y.
+//
+// The composition of F(u) = u + a, where a is a symbolic constant, with
+// G(a) = 2*a, whose variable is named a, is then attempted; this generates
+// an SCC::SymFunException.
+//
+// OUTPUT :
+// ------
+// The constructor string of the composed function, its value at a point,
+// and the maximum difference from the function specified directly.
+//
+//######################################################################
+//
+int main()
+{
+    SCC::SymFun F;
+    SCC::SymFun G;
+    SCC::SymFun H;
+    SCC::SymFun FGHdirect;
+
+    try
+    {
+    	F.initialize({"u","v"},"u*v + sin(u)");
+    	G.initialize({"x","y"},"x^2 + y^2");
+    	H.initialize({"x","y"},"x - y");
+    	FGHdirect.initialize({"x","y"},"(x^2 + y^2)*(x - y) + sin(x^2 + y^2)");
+    }
+    catch (const SCC::SymFunException& e)
+    {
+      std::cerr << e.what() << std::endl;
+      std::cerr << "XXXX Execution Terminated XXXXX" << std::endl;
+      return 1;
+    }
+
+    SCC::SymFunUtility symFunUtility;
+
+    SCC::SymFun FGH = symFunUtility.compose(F,{{"u",G},{"v",H}});
+
+    std::cout << "The composed function : ";
+    std::cout << FGH.getConstructorString()  << std::endl << std::endl;
+
+    std::cout << "The value of the composed function at (x,y) = (1,2) is : ";
+    std::cout << FGH(1.0,2.0) << std::endl << std::endl;
+
+    double x;
+    double y;
+    double maxDiff = 0.0;
+
+    for(long i = 0; i <= 20; i++)
+    {
+    for(long j = 0; j <= 20; j++)
+    {
+    x = -1.0 + 0.1*i;
+    y = -1.0 + 0.1*j;
+    maxDiff = std::max(maxDiff,std::abs(FGH(x,y) - FGHdirect(x,y)));
+    }}
+
+    std::cout << "Maximum difference from the function specified directly : " << maxDiff << std::endl << std::endl;
+
+    if(maxDiff > 1.0e-13)
+    {
+      std::cerr << "Composed function values differ from the direct values" << std::endl;
+      std::cerr << "XXXX Execution Terminated XXXXX" << std::endl;
+      return 1;
+    }
+
+    // a is a symbolic constant of P and the variable of Q
+
+    SCC::SymFun P({"u"},{"a"},{1.0},"u + a");
+    SCC::SymFun Q({"a"},"2*a");
+
+    bool collisionDetected = false;
+    try
+    {
+    	SCC::SymFun PQ = symFunUtility.compose(P,{{"u",Q}});
+    }
+    catch (const SCC::SymFunException& e)
+    {
+      std::cout << "Composition of u + a (constant a) with 2*a (variable a) : " << std::endl;
+      std::cout << e.what() << std::endl;
+      collisionDetected = true;
+    }
+
+    if(!collisionDetected)
+    {
+      std::cerr << "Variable and constant with the same name not detected" << std::endl;
+      std::cerr << "XXXX Execution Terminated XXXXX" << std::endl;
+      return 1;
+    }
+
+    printf("XXXX Execution Complete XXXXX\n");
+    return 0;
+}
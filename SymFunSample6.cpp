@@ -0,0 +1,113 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "SCC_SymFun.h"
+
+//
+//######################################################################
+//
+// SymFun Test Program #6
+//
+// Combines compiled SCC::SymFun instances A(x,y) and B(y,z) with the
+// algebraic operators of SCC::SymFun and compares the results with the
+// functions specified directly in terms of the variables of the results
+// (x, y and z, or x and y for -A).
+//
+// The sum of an instance in which c is a symbolic constant and one in
+// which c is a variable is then formed; this generates an
+// SCC::SymFunException.
+//
+// OUTPUT :
+// ------
+// The constructor string of each combination and the maximum difference
+// from the function specified directly.
+//
+//######################################################################
+//
+int main()
+{
+    SCC::SymFun A;
+    SCC::SymFun B;
+
+    try
+    {
+    	A.initialize({"x","y"},{"a"},{2.0},"a*x + y^2");
+    	B.initialize({"y","z"},"sin(y*z) + 3");
+    }
+    catch (const SCC::SymFunException& e)
+    {
+      std::cerr << e.what() << std::endl;
+      std::cerr << "XXXX Execution Terminated XXXXX" << std::endl;
+      return 1;
+    }
+
+    SCC::SymFun C = 2.0*A - B;
+    C /= (B + 1.0);
+
+    std::vector<SCC::SymFun> F = {A + B, A - B, A*B, A/B, -A, C};
+
+    std::vector<std::string> S = {"(2*x + y^2) + (sin(y*z) + 3)",
+                                  "(2*x + y^2) - (sin(y*z) + 3)",
+                                  "(2*x + y^2)*(sin(y*z) + 3)",
+                                  "(2*x + y^2)/(sin(y*z) + 3)",
+                                  "-(2*x + y^2)",
+                                  "(2*(2*x + y^2) - (sin(y*z) + 3))/((sin(y*z) + 3) + 1)"};
+
+    double maxDiff = 0.0;
+    double diff;
+
+    for(size_t j = 0; j < F.size(); j++)
+    {
+    SCC::SymFun Fdirect(F[j].getVariableNames(),S[j]);
+
+    diff = 0.0;
+    for(long k = 0; k < 100; k++)
+    {
+    std::vector<double> x = {0.1*k - 5.0, 0.03*k, 1.0 - 0.02*k};
+    x.resize(F[j].getVariableCount());
+    diff = std::max(diff,std::abs(F[j](x) - Fdirect(x)));
+    }
+    maxDiff = std::max(maxDiff,diff);
+
+    std::cout << F[j].getConstructorString() << " : maximum difference = " << diff << std::endl;
+    }
+    std::cout << std::endl;
+
+    if(maxDiff > 1.0e-13)
+    {
+      std::cerr << "Values of the combined functions differ from the direct values" << std::endl;
+      std::cerr << "XXXX Execution Terminated XXXXX" << std::endl;
+      return 1;
+    }
+
+    // c is a symbolic constant of P and a variable of Q
+
+    SCC::SymFun P({"x"},{"c"},{1.0},"c*x");
+    SCC::SymFun Q({"c"},"c^2");
+
+    bool collisionDetected = false;
+    try
+    {
+    	SCC::SymFun PQ = P + Q;
+    }
+    catch (const SCC::SymFunException& e)
+    {
+      std::cout << "Sum of c*x (constant c) and c^2 (variable c) : " << std::endl;
+      std::cout << e.what() << std::endl;
+      collisionDetected = true;
+    }
+
+    if(!collisionDetected)
+    {
+      std::cerr << "Variable and constant with the same name not detected" << std::endl;
+      std::cerr << "XXXX Execution Terminated XXXXX" << std::endl;
+      return 1;
+    }
+
+    printf("XXXX Execution Complete XXXXX\n");
+    return 0;
+}